@@ -0,0 +1,50 @@
+"""
+bench_alloc.py
+
+    Stress test of the scratch arena. Draws lines, rectangles and text in a
+    loop and prints how many temporary buffers had to come from the heap
+    (stats()['allocs']) and how long each round took. After the first round
+    the allocation count should stay at zero.
+"""
+
+import random
+import time
+import gc
+import rm67162
+import tft_config
+import vga2_bold_16x32 as font
+
+tft = tft_config.config()
+
+
+def round_of_drawing():
+    width = tft.width()
+    height = tft.height()
+    for _ in range(200):
+        x = random.randint(0, width - 1)
+        y = random.randint(0, height - 1)
+        color = random.getrandbits(16)
+        tft.hline(0, y, width, color)
+        tft.vline(x, 0, height, color)
+        tft.fill_rect(x // 2, y // 2, width // 4, height // 4, color)
+        tft.text(font, b'0123', 0, 0, color, rm67162.BLACK)
+
+
+def main():
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+    tft.fill(rm67162.BLACK)
+
+    for n in range(5):
+        tft.reset_stats()
+        gc.collect()
+        free = gc.mem_free()
+        start = time.ticks_ms()
+        round_of_drawing()
+        took = time.ticks_diff(time.ticks_ms(), start)
+        print('round {}: {} ms, {} heap allocations, {} bytes of GC heap used'.format(
+            n, took, tft.stats()['allocs'], free - gc.mem_free()))
+
+
+main()
@@ -0,0 +1,61 @@
+"""
+bench_batch.py
+
+    Draws a bar chart and a scatter plot once with a call per primitive and
+    once with a single fill_rects() or pixels() call, and reports the bus
+    transactions, bytes and time of both.
+"""
+
+import time
+import random
+from array import array
+import rm67162
+import tft_config
+
+tft = tft_config.config()
+panel = tft_config.panel
+
+
+def measure(name, func):
+    tft.fill(rm67162.BLACK)
+    panel.reset_stats()
+    start = time.ticks_us()
+    func()
+    took = time.ticks_diff(time.ticks_us(), start)
+    trans, sent = panel.stats()
+    print('{:<24} {:>6} transactions {:>8} bytes {:>7} us'.format(name, trans, sent, took))
+
+
+def main():
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+
+    width = tft.width()
+    height = tft.height()
+
+    bars = array('h')
+    for x in range(0, width, 4):
+        h = random.randint(1, height)
+        bars.extend((x, height - h, 3, h, rm67162.GREEN))
+
+    def bar_calls():
+        for i in range(0, len(bars), 5):
+            tft.fill_rect(bars[i], bars[i + 1], bars[i + 2], bars[i + 3], bars[i + 4])
+
+    measure('bars fill_rect', bar_calls)
+    measure('bars fill_rects', lambda: tft.fill_rects(bars))
+
+    dots = array('h')
+    for _ in range(1000):
+        dots.extend((random.randint(0, width - 1), random.randint(0, height - 1)))
+
+    def dot_calls():
+        for i in range(0, len(dots), 2):
+            tft.pixel(dots[i], dots[i + 1], rm67162.YELLOW)
+
+    measure('scatter pixel', dot_calls)
+    measure('scatter pixels', lambda: tft.pixels(dots, rm67162.YELLOW))
+
+
+main()
@@ -0,0 +1,54 @@
+"""
+bench_fill.py
+
+    Compares full screen clears. fill() repeats a 4096 byte block within one
+    transfer, the buffered path sends a 4288 pixel buffer band by band the way
+    fill() used to. Prints the time, the bus transactions and bytes and the
+    GC heap used by each.
+"""
+
+import time
+import gc
+import rm67162
+import tft_config
+
+tft = tft_config.config()
+panel = tft_config.panel
+
+BAND = 8
+ROUNDS = 20
+
+
+def buffered_fill(buf, color):
+    width = tft.width()
+    for i in range(0, len(buf), 2):
+        buf[i] = color & 0xFF
+        buf[i + 1] = color >> 8
+    for y in range(0, tft.height(), BAND):
+        tft.bitmap(0, y, width, y + BAND, buf)
+
+
+def measure(name, func):
+    gc.collect()
+    free = gc.mem_free()
+    panel.reset_stats()
+    start = time.ticks_us()
+    for n in range(ROUNDS):
+        func(rm67162.RED if n & 1 else rm67162.BLUE)
+    took = time.ticks_diff(time.ticks_us(), start) // ROUNDS
+    trans, sent = panel.stats()
+    print('{}: {} us, {} transactions, {} bytes per clear, {} bytes of GC heap'.format(
+        name, took, trans // ROUNDS, sent // ROUNDS, free - gc.mem_free()))
+
+
+def main():
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+
+    buf = bytearray(tft.width() * BAND * 2)
+    measure('fill()', tft.fill)
+    measure('buffered', lambda color: buffered_fill(buf, color))
+
+
+main()
@@ -0,0 +1,69 @@
+"""
+bench_shapes.py
+
+    Reports the bus transactions, bytes and time per filled circle for a
+    range of radii, and for fill_bubble_rect() and bubble_rect(). Outlines
+    are measured drawn pixel by pixel and over their bounding box with a
+    background color. A gauge of 12 rotated needles is filled from point
+    lists and from precompiled Shape objects.
+"""
+
+import math
+import time
+import rm67162
+import tft_config
+
+tft = tft_config.config()
+panel = tft_config.panel
+
+
+def measure(name, func):
+    tft.fill(rm67162.BLACK)
+    panel.reset_stats()
+    start = time.ticks_us()
+    func()
+    took = time.ticks_diff(time.ticks_us(), start)
+    trans, sent = panel.stats()
+    print('{:<24} {:>6} transactions {:>8} bytes {:>7} us'.format(name, trans, sent, took))
+
+
+def main():
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+
+    cx = tft.width() // 2
+    cy = tft.height() // 2
+    for r in (5, 10, 25, 50, 100, 119):
+        measure('fill_circle r={}'.format(r), lambda: tft.fill_circle(cx, cy, r, rm67162.RED))
+
+    measure('fill_bubble_rect 200x100', lambda: tft.fill_bubble_rect(10, 10, 200, 100, rm67162.GREEN))
+    measure('bubble_rect 200x100', lambda: tft.bubble_rect(10, 10, 200, 100, rm67162.GREEN))
+    measure('  with background', lambda: tft.bubble_rect(10, 10, 200, 100, rm67162.GREEN, rm67162.BLACK))
+
+    for r in (25, 100):
+        measure('circle r={}'.format(r), lambda: tft.circle(cx, cy, r, rm67162.RED))
+        measure('  with background', lambda: tft.circle(cx, cy, r, rm67162.RED, rm67162.BLACK))
+
+    star = [(0, -100), (29, -40), (95, -31), (48, 15), (59, 81), (0, 50),
+            (-59, 81), (-48, 15), (-95, -31), (-29, -40), (0, -100)]
+    measure('polygon star', lambda: tft.polygon(star, cx, cy, rm67162.YELLOW))
+    measure('  with background', lambda: tft.polygon(star, cx, cy, rm67162.YELLOW, 0, 0, 0, rm67162.BLACK))
+
+    needle = [(-3, 0), (0, -60), (3, 0), (0, 8)]
+    shapes = [rm67162.Shape(needle) for _ in range(12)]
+    angles = [i * math.pi / 6 for i in range(12)]
+
+    def gauge_lists():
+        for angle in angles:
+            tft.fill_polygon(needle, cx, cy, rm67162.WHITE, angle)
+
+    def gauge_shapes():
+        for shape, angle in zip(shapes, angles):
+            tft.fill_polygon(shape, cx, cy, rm67162.WHITE, angle)
+
+    measure('gauge from lists', gauge_lists)
+    measure('gauge from shapes', gauge_shapes)
+
+
+main()
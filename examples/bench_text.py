@@ -0,0 +1,50 @@
+"""
+bench_text.py
+
+    Reports the bus transactions, bytes and time of text() for a 60
+    character status line, one that runs over the right edge and a single
+    character. A clock printed 100 times shows the glyph cache hits and
+    the time per update.
+"""
+
+import time
+import rm67162
+import tft_config
+import vga1_8x16 as font
+
+tft = tft_config.config(glyph_cache=8192)
+panel = tft_config.panel
+
+STATUS = 'CPU 42%  MEM 117k  TEMP 38.5C  NET up 12k/s  BAT 87%  12:04'
+
+
+def measure(name, func):
+    tft.fill(rm67162.BLACK)
+    panel.reset_stats()
+    start = time.ticks_us()
+    func()
+    took = time.ticks_diff(time.ticks_us(), start)
+    trans, sent = panel.stats()
+    print('{:<24} {:>6} transactions {:>8} bytes {:>7} us'.format(name, trans, sent, took))
+
+
+def main():
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+
+    measure('status line', lambda: tft.text(font, STATUS, 0, 0, rm67162.WHITE, rm67162.BLUE))
+    measure('over the right edge', lambda: tft.text(font, STATUS, tft.width() - 100, 20, rm67162.WHITE, rm67162.BLUE))
+    measure('single character', lambda: tft.text(font, 'A', 0, 40, rm67162.WHITE, rm67162.BLUE))
+
+    tft.reset_stats()
+    start = time.ticks_us()
+    for second in range(100):
+        tft.text(font, '12:04:{:02}'.format(second % 60), 0, 60, rm67162.GREEN, rm67162.BLACK)
+    took = time.ticks_diff(time.ticks_us(), start)
+    stats = tft.stats()
+    print('clock {:>5} us per update, {} glyph hits, {} misses'.format(
+        took // 100, stats['glyph_hits'], stats['glyph_misses']))
+
+
+main()
@@ -0,0 +1,63 @@
+"""
+bench_write.py
+
+    Micro-benchmark of the glyph lookup of write() and write_len(). Creates
+    a 200 glyph proportional font module, then times both on strings of
+    characters from the start and from the end of its MAP. With the glyph
+    index built on first use both should take about the same time per
+    character.
+"""
+
+import os
+import time
+import random
+import rm67162
+import tft_config
+
+tft = tft_config.config()
+
+FONT = 'bench_font_200'
+
+
+def make_font():
+    chars = ''.join(chr(c) for c in range(0x20, 0x7f)) + ''.join(chr(c) for c in range(0x100, 0x100 + 105))
+    with open(FONT + '.py', 'w') as f:
+        f.write('MAP = {!r}\n'.format(chars))
+        f.write('BPP = 1\nHEIGHT = 16\nMAX_WIDTH = 8\nOFFSET_WIDTH = 2\n')
+        f.write('WIDTHS = {!r}\n'.format(bytes([8] * len(chars))))
+        offsets = bytearray()
+        for i in range(len(chars)):
+            offsets.extend(((i * 128) >> 8, (i * 128) & 0xff))
+        f.write('OFFSETS = {!r}\n'.format(bytes(offsets)))
+        f.write('BITMAPS = {!r}\n'.format(bytes(random.getrandbits(8) for _ in range(len(chars) * 16))))
+    return chars
+
+
+def measure(name, func, chars):
+    start = time.ticks_us()
+    func()
+    took = time.ticks_diff(time.ticks_us(), start)
+    print('{:<24} {:>7} us {:>6} us/char'.format(name, took, took // chars))
+
+
+def main():
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+    tft.fill(rm67162.BLACK)
+
+    chars = make_font()
+    font = __import__(FONT)
+    first = chars[:25] * 4
+    last = chars[-25:] * 4
+
+    measure('index build', lambda: tft.write_len(font, 'A'), 1)
+    measure('write_len first', lambda: tft.write_len(font, first), len(first))
+    measure('write_len last', lambda: tft.write_len(font, last), len(last))
+    measure('write first', lambda: tft.write(font, first[:25], 0, 0), 25)
+    measure('write last', lambda: tft.write(font, last[:25], 0, 20), 25)
+
+    os.remove(FONT + '.py')
+
+
+main()
@@ -0,0 +1,16 @@
+import tft_config
+
+# logo.raw is made by: img_to_bytearray.py --raw -w 320 -ht 170 logo.png
+WIDTH = const(320)
+HEIGHT = const(170)
+
+
+def main():
+    tft = tft_config.config()
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+    # streamed from flash in bands, the image is never held in ram
+    tft.bitmap_file("logo.raw", 0, 0, WIDTH, HEIGHT)
+
+main()
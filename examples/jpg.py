@@ -0,0 +1,28 @@
+"""
+Draws a JPEG at full size and as thumbnails at 1/2, 1/4 and 1/8.
+Copy a photo to the board as photo.jpg first.
+"""
+
+import time
+import tft_config
+
+
+def main():
+    tft = tft_config.config()
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+
+    t0 = time.ticks_ms()
+    width, height = tft.jpg("photo.jpg", 0, 0)
+    print("full {}x{}: {} ms".format(width, height, time.ticks_diff(time.ticks_ms(), t0)))
+
+    x = 0
+    for scale in (2, 4, 8):
+        t0 = time.ticks_ms()
+        w, h = tft.jpg("photo.jpg", x, 0, scale)
+        print("1/{} {}x{}: {} ms".format(scale, w, h, time.ticks_diff(time.ticks_ms(), t0)))
+        x += w
+
+
+main()
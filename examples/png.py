@@ -0,0 +1,26 @@
+"""
+Draws a PNG with transparency over two background colors.
+Copy an image to the board as logo.png first.
+"""
+
+import time
+import rm67162
+import tft_config
+
+
+def main():
+    tft = tft_config.config()
+    tft.reset()
+    tft.init()
+    tft.rotation(1)
+
+    x = 0
+    for bg in (rm67162.BLACK, rm67162.WHITE):
+        tft.fill_rect(x, 0, tft.width() // 2, tft.height(), bg)
+        t0 = time.ticks_ms()
+        width, height = tft.png("logo.png", x, 0, bg)
+        print("{}x{}: {} ms".format(width, height, time.ticks_diff(time.ticks_ms(), t0)))
+        x += tft.width() // 2
+
+
+main()
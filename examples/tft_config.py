@@ -1,7 +1,11 @@
 import rm67162
 from machine import Pin, SPI
 
-def config():
+panel = None
+
+
+def config(**kwargs):
+    global panel
     hspi = SPI(2, sck=Pin(47), mosi=None, miso=None, polarity=0, phase=0)
     panel = rm67162.QSPIPanel(
         spi=hspi,
@@ -12,7 +16,7 @@ def config():
         width=240,
         height=536
     )
-    return rm67162.RM67162(panel, reset=Pin(17), BPP=16)
+    return rm67162.RM67162(panel, reset=Pin(17), BPP=16, **kwargs)
 
 
 def color565(r, g, b):
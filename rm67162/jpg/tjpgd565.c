@@ -0,0 +1,612 @@
+#include "tjpgd565.h"
+
+#include <string.h>
+
+
+// Order of the coefficients in the stream.
+static const uint8_t zigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+
+// Scale factors of the AAN IDCT, cos(k * pi / 16) * sqrt(2) in 2.14.
+static const uint16_t aanscale[8] = {
+    16384, 22725, 21407, 19266, 16384, 12873, 8867, 4520,
+};
+
+
+static uint8_t clamp(int32_t v) {
+    return (v < 0) ? 0 : (v > 255) ? 255 : v;
+}
+
+
+// Coefficients of a damaged stream are limited so the IDCT cannot overflow.
+#define COEF_MAX (1 << 20)
+
+static int32_t coef_clamp(int32_t v) {
+    return (v < -COEF_MAX) ? -COEF_MAX : (v > COEF_MAX) ? COEF_MAX : v;
+}
+
+
+/*
+Input. Headers are read a byte at a time from inbuf, which the input function
+refills.
+*/
+
+static int read_byte(JDEC *jd) {
+    if (jd->dctr == 0) {
+        jd->dctr = jd->infunc(jd, jd->inbuf, JD_SZBUF);
+        jd->dptr = jd->inbuf;
+        if (jd->dctr == 0) {
+            return -1;
+        }
+    }
+    jd->dctr--;
+    return *jd->dptr++;
+}
+
+
+static int read_word(JDEC *jd) {
+    int hi = read_byte(jd);
+    int lo = read_byte(jd);
+    return (hi < 0 || lo < 0) ? -1 : (hi << 8) | lo;
+}
+
+
+// The code of the next marker, -1 at the end of the input.
+static int read_marker(JDEC *jd) {
+    int c;
+    do {
+        c = read_byte(jd);
+    } while (c >= 0 && c != 0xFF);
+    while (c == 0xFF) {
+        c = read_byte(jd);
+    }
+    return c;
+}
+
+
+/*
+Headers.
+*/
+
+static JRESULT read_dqt(JDEC *jd, int len) {
+    while (len > 0) {
+        int pq = read_byte(jd);
+        if (pq < 0) {
+            return JDR_INP;
+        }
+        if (pq >> 4) {
+            return JDR_FMT3;            // 16 bit tables are for 12 bit samples
+        }
+        int32_t *qt = jd->qt[pq & 3];
+        for (int i = 0; i < 64; i++) {
+            int q = read_byte(jd);
+            if (q < 0) {
+                return JDR_INP;
+            }
+            // 6 fraction bits keep the small factors of fine tables apart
+            int k = zigzag[i];
+            qt[k] = ((int32_t)q * (((int32_t)aanscale[k >> 3] * aanscale[k & 7] + 8192) >> 14) + 128) >> 8;
+        }
+        jd->qt_valid |= 1 << (pq & 3);
+        len -= 65;
+    }
+    return (len == 0) ? JDR_OK : JDR_FMT1;
+}
+
+
+static JRESULT read_dht(JDEC *jd, int len) {
+    while (len > 0) {
+        int tc = read_byte(jd);
+        if (tc < 0) {
+            return JDR_INP;
+        }
+        if ((tc >> 4) > 1 || (tc & 15) > 1) {
+            return JDR_FMT3;
+        }
+        JHUFF *h = &jd->huff[tc >> 4][tc & 15];
+
+        uint8_t counts[17];
+        int total = 0;
+        for (int l = 1; l <= 16; l++) {
+            int n = read_byte(jd);
+            if (n < 0) {
+                return JDR_INP;
+            }
+            counts[l] = n;
+            total += n;
+        }
+        if (total > 256) {
+            return JDR_FMT1;
+        }
+        for (int i = 0; i < total; i++) {
+            int v = read_byte(jd);
+            if (v < 0) {
+                return JDR_INP;
+            }
+            h->values[i] = v;
+        }
+
+        // canonical codes, the short ones also go into the lookup table
+        memset(h->lookup, 0, sizeof(h->lookup));
+        uint32_t code = 0;
+        int k = 0;
+        for (int l = 1; l <= 16; l++) {
+            h->valptr[l] = k;
+            h->mincode[l] = code;
+            if (code + counts[l] > (1u << l)) {
+                return JDR_FMT1;
+            }
+            for (int i = 0; i < counts[l]; i++, k++, code++) {
+                if (l <= JD_LOOKUP_BITS) {
+                    int shift = JD_LOOKUP_BITS - l;
+                    for (uint32_t j = 0; j < (1u << shift); j++) {
+                        h->lookup[(code << shift) | j] = (l << 8) | h->values[k];
+                    }
+                }
+            }
+            h->maxcode[l] = (counts[l]) ? (int32_t)code - 1 : -1;
+            code <<= 1;
+        }
+        jd->huff_valid |= 1 << (tc >> 4 << 1 | (tc & 15));
+        len -= 17 + total;
+    }
+    return (len == 0) ? JDR_OK : JDR_FMT1;
+}
+
+
+static JRESULT read_sof(JDEC *jd, int len) {
+    uint8_t b[6 + 3 * 3];
+    if (len < 6) {
+        return JDR_FMT1;
+    }
+    for (int i = 0; i < 6; i++) {
+        int c = read_byte(jd);
+        if (c < 0) {
+            return JDR_INP;
+        }
+        b[i] = c;
+    }
+    if (b[0] != 8) {
+        return JDR_FMT3;
+    }
+    jd->height = b[1] << 8 | b[2];
+    jd->width = b[3] << 8 | b[4];
+    jd->ncomp = b[5];
+    if (jd->width == 0 || jd->height == 0 || (jd->ncomp != 1 && jd->ncomp != 3)) {
+        return JDR_FMT3;
+    }
+    if (len != 6 + 3 * jd->ncomp) {
+        return JDR_FMT1;
+    }
+    for (int i = 0; i < 3 * jd->ncomp; i++) {
+        int c = read_byte(jd);
+        if (c < 0) {
+            return JDR_INP;
+        }
+        b[6 + i] = c;
+    }
+
+    // the sampling of a single component does not matter
+    jd->msx = (jd->ncomp == 1) ? 1 : b[7] >> 4;
+    jd->msy = (jd->ncomp == 1) ? 1 : b[7] & 15;
+    if (jd->msx < 1 || jd->msx > 2 || jd->msy < 1 || jd->msy > 2) {
+        return JDR_FMT3;
+    }
+    for (int i = 0; i < jd->ncomp; i++) {
+        if (i > 0 && b[7 + 3 * i] != 0x11) {
+            return JDR_FMT3;
+        }
+        jd->qtid[i] = b[8 + 3 * i] & 3;
+    }
+    return JDR_OK;
+}
+
+
+static JRESULT read_sos(JDEC *jd, int len) {
+    int ns = read_byte(jd);
+    if (ns < 0) {
+        return JDR_INP;
+    }
+    // one interleaved scan of all components
+    if (ns != jd->ncomp || len != 4 + 2 * ns) {
+        return JDR_FMT3;
+    }
+    for (int i = 0; i < ns; i++) {
+        read_byte(jd);
+        int td = read_byte(jd);
+        if (td < 0) {
+            return JDR_INP;
+        }
+        jd->dcid[i] = (td >> 4) & 1;
+        jd->acid[i] = td & 1;
+        if (!(jd->huff_valid & (1 << jd->dcid[i])) || !(jd->huff_valid & (1 << (2 + jd->acid[i]))) ||
+            !(jd->qt_valid & (1 << jd->qtid[i]))) {
+            return JDR_FMT1;
+        }
+    }
+    // spectral selection and approximation of a sequential scan
+    for (int i = 0; i < 3; i++) {
+        if (read_byte(jd) < 0) {
+            return JDR_INP;
+        }
+    }
+    return JDR_OK;
+}
+
+
+JRESULT jd_prepare(JDEC *jd, jd_infunc_t infunc, void *device) {
+    jd->infunc = infunc;
+    jd->device = device;
+    jd->dctr = 0;
+    jd->width = 0;
+    jd->height = 0;
+    jd->nrst = 0;
+    jd->qt_valid = 0;
+    jd->huff_valid = 0;
+
+    if (read_byte(jd) != 0xFF || read_byte(jd) != 0xD8) {
+        return JDR_INP;
+    }
+
+    for (;;) {
+        int marker = read_marker(jd);
+        if (marker < 0) {
+            return JDR_INP;
+        }
+        int len = read_word(jd);
+        if (len < 2) {
+            return JDR_INP;
+        }
+        len -= 2;
+
+        JRESULT res = JDR_OK;
+        switch (marker) {
+            case 0xC0:                  // baseline
+            case 0xC1:                  // extended sequential, Huffman coded
+                res = read_sof(jd, len);
+                break;
+
+            case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+            case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+                return JDR_FMT3;
+
+            case 0xC4:
+                res = read_dht(jd, len);
+                break;
+
+            case 0xDB:
+                res = read_dqt(jd, len);
+                break;
+
+            case 0xDD:
+                if (len != 2) {
+                    return JDR_FMT1;
+                }
+                jd->nrst = read_word(jd);
+                break;
+
+            case 0xDA:
+                if (jd->width == 0) {
+                    return JDR_FMT1;
+                }
+                return read_sos(jd, len);
+
+            case 0xD9:
+                return JDR_FMT1;
+
+            default:                    // APPn, COM and others are skipped
+                while (len-- > 0) {
+                    if (read_byte(jd) < 0) {
+                        return JDR_INP;
+                    }
+                }
+                break;
+        }
+        if (res != JDR_OK) {
+            return res;
+        }
+    }
+}
+
+
+/*
+Entropy coded data. A marker in the data ends it, from then on zero bits are
+read until the marker is taken, see restart().
+*/
+
+static void fill_bits(JDEC *jd) {
+    while (jd->bitcnt <= 24) {
+        int c = 0;
+        if (!jd->marker) {
+            c = read_byte(jd);
+            if (c < 0) {
+                jd->marker = 0xD9;
+                c = 0;
+            } else if (c == 0xFF) {
+                int m = read_byte(jd);
+                while (m == 0xFF) {
+                    m = read_byte(jd);
+                }
+                if (m != 0) {
+                    jd->marker = (m < 0) ? 0xD9 : m;
+                    c = 0;
+                }
+            }
+        }
+        jd->bitbuf |= (uint32_t)c << (24 - jd->bitcnt);
+        jd->bitcnt += 8;
+    }
+}
+
+
+static int get_bits(JDEC *jd, int n) {
+    fill_bits(jd);
+    int v = jd->bitbuf >> (32 - n);
+    jd->bitbuf <<= n;
+    jd->bitcnt -= n;
+    return v;
+}
+
+
+// The next Huffman coded value, -1 for an invalid code.
+static int get_huff(JDEC *jd, const JHUFF *h) {
+    fill_bits(jd);
+    uint16_t e = h->lookup[jd->bitbuf >> (32 - JD_LOOKUP_BITS)];
+    if (e) {
+        jd->bitbuf <<= e >> 8;
+        jd->bitcnt -= e >> 8;
+        return e & 0xFF;
+    }
+    for (int l = JD_LOOKUP_BITS + 1; l <= 16; l++) {
+        int32_t code = jd->bitbuf >> (32 - l);
+        if (code <= h->maxcode[l]) {
+            jd->bitbuf <<= l;
+            jd->bitcnt -= l;
+            return h->values[h->valptr[l] + code - h->mincode[l]];
+        }
+    }
+    return -1;
+}
+
+
+// Value of n bits in the sign coding of JPEG.
+static int32_t extend(int32_t v, int n) {
+    return (v < (1 << (n - 1))) ? v - (1 << n) + 1 : v;
+}
+
+
+// Takes the restart marker at the end of an interval.
+static JRESULT restart(JDEC *jd) {
+    jd->bitbuf = 0;
+    jd->bitcnt = 0;
+    while (!jd->marker) {
+        int m = read_marker(jd);
+        jd->marker = (m < 0) ? 0xD9 : m;
+    }
+    if (jd->marker < 0xD0 || jd->marker > 0xD7) {
+        return JDR_FMT1;
+    }
+    jd->marker = 0;
+    jd->dcv[0] = jd->dcv[1] = jd->dcv[2] = 0;
+    return JDR_OK;
+}
+
+
+#define MUL(x, c) ((int32_t)(((int64_t)(x) * (c)) >> 8))
+#define C_1_414 362                     // constants of the AAN IDCT in 8 bits
+#define C_1_847 473
+#define C_1_082 277
+#define C_2_613 669
+
+// 1-D AAN IDCT over 8 values step apart.
+static void idct_1d(int32_t *d, int step) {
+    int32_t t0 = d[0];
+    int32_t t1 = d[2 * step];
+    int32_t t2 = d[4 * step];
+    int32_t t3 = d[6 * step];
+    int32_t t10 = t0 + t2;
+    int32_t t11 = t0 - t2;
+    int32_t t13 = t1 + t3;
+    int32_t t12 = MUL(t1 - t3, C_1_414) - t13;
+    t0 = t10 + t13;
+    t3 = t10 - t13;
+    t1 = t11 + t12;
+    t2 = t11 - t12;
+
+    int32_t z13 = d[5 * step] + d[3 * step];
+    int32_t z10 = d[5 * step] - d[3 * step];
+    int32_t z11 = d[1 * step] + d[7 * step];
+    int32_t z12 = d[1 * step] - d[7 * step];
+    int32_t t7 = z11 + z13;
+    t11 = MUL(z11 - z13, C_1_414);
+    int32_t z5 = MUL(z10 + z12, C_1_847);
+    t10 = MUL(z12, C_1_082) - z5;
+    t12 = z5 - MUL(z10, C_2_613);
+    int32_t t6 = t12 - t7;
+    int32_t t5 = t11 - t6;
+    int32_t t4 = t10 + t5;
+
+    d[0] = t0 + t7;
+    d[7 * step] = t0 - t7;
+    d[1 * step] = t1 + t6;
+    d[6 * step] = t1 - t6;
+    d[2 * step] = t2 + t5;
+    d[5 * step] = t2 - t5;
+    d[4 * step] = t3 + t4;
+    d[3 * step] = t3 - t4;
+}
+
+
+// Decodes a block of component c into (8 >> scale) squared samples, the
+// averages of the pixel they cover.
+static JRESULT decode_block(JDEC *jd, int c, uint8_t scale, uint8_t *out) {
+    const int32_t *qt = jd->qt[jd->qtid[c]];
+    int32_t coef[64];
+
+    int s = get_huff(jd, &jd->huff[0][jd->dcid[c]]);
+    if (s < 0 || s > 11) {
+        return JDR_FMT1;
+    }
+    if (s) {
+        jd->dcv[c] += extend(get_bits(jd, s), s);
+        jd->dcv[c] = (jd->dcv[c] < -4096) ? -4096 : (jd->dcv[c] > 4096) ? 4096 : jd->dcv[c];
+    }
+
+    // the DC value alone at 1/8
+    if (scale == 3) {
+        for (int k = 1; k < 64; k++) {
+            int rs = get_huff(jd, &jd->huff[1][jd->acid[c]]);
+            if (rs < 0) {
+                return JDR_FMT1;
+            }
+            if ((rs & 15) == 0) {
+                if (rs != 0xF0) {
+                    break;
+                }
+                k += 15;
+            } else {
+                k += rs >> 4;
+                get_bits(jd, rs & 15);
+            }
+        }
+        out[0] = clamp(((jd->dcv[c] * qt[0] + 256) >> 9) + 128);
+        return JDR_OK;
+    }
+
+    memset(coef, 0, sizeof(coef));
+    coef[0] = coef_clamp(jd->dcv[c] * qt[0]);
+    for (int k = 1; k < 64; k++) {
+        int rs = get_huff(jd, &jd->huff[1][jd->acid[c]]);
+        if (rs < 0) {
+            return JDR_FMT1;
+        }
+        if ((rs & 15) == 0) {
+            if (rs != 0xF0) {
+                break;
+            }
+            k += 15;
+            continue;
+        }
+        k += rs >> 4;
+        if (k > 63) {
+            return JDR_FMT1;
+        }
+        int z = zigzag[k];
+        coef[z] = coef_clamp(extend(get_bits(jd, rs & 15), rs & 15) * qt[z]);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        idct_1d(coef + i, 8);
+    }
+    for (int i = 0; i < 8; i++) {
+        idct_1d(coef + 8 * i, 1);
+    }
+
+    // 6 fraction bits and 3 bits of gain, 1 << 2 * scale pixel are averaged
+    int n = 8 >> scale;
+    int shift = 9 + 2 * scale;
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            int32_t sum = 0;
+            for (int yy = 0; yy < (1 << scale); yy++) {
+                for (int xx = 0; xx < (1 << scale); xx++) {
+                    sum += coef[((y << scale) + yy) * 8 + (x << scale) + xx];
+                }
+            }
+            out[y * n + x] = clamp(((sum + (1 << (shift - 1))) >> shift) + 128);
+        }
+    }
+    return JDR_OK;
+}
+
+
+// Converts the samples of an MCU into color565 in the byte order of the panel.
+static void mcu_to_565(JDEC *jd, uint8_t scale, int w, int h) {
+    int n = 8 >> scale;
+    int nluma = jd->msx * jd->msy;
+    uint16_t *p = jd->pixels;
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int yv = jd->mcubuf[(y / n) * jd->msx + x / n][(y % n) * n + x % n];
+            int r, g, b;
+            if (jd->ncomp == 1) {
+                r = g = b = yv;
+            } else {
+                int ci = (y / jd->msy) * n + x / jd->msx;
+                int cb = jd->mcubuf[nluma][ci] - 128;
+                int cr = jd->mcubuf[nluma + 1][ci] - 128;
+                r = clamp(yv + ((91881 * cr + 32768) >> 16));
+                g = clamp(yv - ((22554 * cb + 46802 * cr - 32768) >> 16));
+                b = clamp(yv + ((116130 * cb + 32768) >> 16));
+            }
+            uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+            *p++ = (c >> 8) | (c << 8);
+        }
+    }
+}
+
+
+JRESULT jd_decomp(JDEC *jd, jd_outfunc_t outfunc, uint8_t scale) {
+    if (scale > 3) {
+        return JDR_PAR;
+    }
+    int n = 8 >> scale;
+    int mw = jd->msx * 8;               // MCU in image pixel
+    int mh = jd->msy * 8;
+    int width = (jd->width + (1 << scale) - 1) >> scale;
+    int height = (jd->height + (1 << scale) - 1) >> scale;
+    int nluma = jd->msx * jd->msy;
+
+    jd->bitbuf = 0;
+    jd->bitcnt = 0;
+    jd->marker = 0;
+    jd->dcv[0] = jd->dcv[1] = jd->dcv[2] = 0;
+
+    uint32_t mcu = 0;
+    for (int my = 0; my < jd->height; my += mh) {
+        for (int mx = 0; mx < jd->width; mx += mw) {
+            if (jd->nrst && mcu && mcu % jd->nrst == 0) {
+                JRESULT res = restart(jd);
+                if (res != JDR_OK) {
+                    return res;
+                }
+            }
+            mcu++;
+
+            for (int b = 0; b < nluma; b++) {
+                JRESULT res = decode_block(jd, 0, scale, jd->mcubuf[b]);
+                if (res != JDR_OK) {
+                    return res;
+                }
+            }
+            for (int c = 1; c < jd->ncomp; c++) {
+                JRESULT res = decode_block(jd, c, scale, jd->mcubuf[nluma + c - 1]);
+                if (res != JDR_OK) {
+                    return res;
+                }
+            }
+
+            // MCUs at the right and bottom edge are cut to the image
+            JRECT rect;
+            rect.left = mx >> scale;
+            rect.top = my >> scale;
+            rect.right = ((rect.left + jd->msx * n < width) ? rect.left + jd->msx * n : width) - 1;
+            rect.bottom = ((rect.top + jd->msy * n < height) ? rect.top + jd->msy * n : height) - 1;
+            mcu_to_565(jd, scale, rect.right - rect.left + 1, rect.bottom - rect.top + 1);
+            if (!outfunc(jd, jd->pixels, &rect)) {
+                return JDR_INTR;
+            }
+        }
+    }
+    return JDR_OK;
+}
@@ -0,0 +1,88 @@
+#ifndef __TJPGD565_H__
+#define __TJPGD565_H__
+
+/*
+Tiny baseline JPEG decoder writing color565 pixels.
+
+The image is read through an input function and decoded one MCU at a time,
+each MCU is handed to an output function as a rectangle of pixels, so a whole
+decoded frame is never held in memory. Sequential 8 bit JPEG with 1 or 3
+components is supported, luma sampled 1x1, 2x1, 1x2 or 2x2 and chroma 1x1,
+with restart intervals. Progressive and arithmetic coded files are not.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define JD_SZBUF        512     // bytes of the input buffer
+#define JD_LOOKUP_BITS  9       // Huffman codes up to this length are looked up at once
+
+typedef enum {
+    JDR_OK = 0,     // succeeded
+    JDR_INTR,       // interrupted by the output function
+    JDR_INP,        // the input ended or is not a JPEG stream
+    JDR_PAR,        // bad parameter
+    JDR_FMT1,       // data format error, the stream may be damaged
+    JDR_FMT3,       // not supported JPEG standard
+} JRESULT;
+
+// Rectangle of an MCU in the scaled image, right and bottom inclusive.
+typedef struct {
+    uint16_t left;
+    uint16_t right;
+    uint16_t top;
+    uint16_t bottom;
+} JRECT;
+
+typedef struct {
+    uint16_t lookup[1 << JD_LOOKUP_BITS];   // length << 8 | value, 0 for longer codes
+    int32_t maxcode[17];                    // largest code of each length, -1 if none
+    uint16_t mincode[17];
+    uint8_t valptr[17];
+    uint8_t values[256];
+} JHUFF;
+
+typedef struct JDEC JDEC;
+
+// Reads up to len bytes into buf, returns the bytes read, 0 at the end.
+typedef size_t (*jd_infunc_t)(JDEC *jd, uint8_t *buf, size_t len);
+
+// Takes the pixels of rect, (right - left + 1) a row. Returns 0 to stop.
+typedef int (*jd_outfunc_t)(JDEC *jd, const uint16_t *pixels, const JRECT *rect);
+
+struct JDEC {
+    jd_infunc_t infunc;
+    void *device;               // for the input and output functions
+    uint16_t width;             // of the image
+    uint16_t height;
+    uint8_t ncomp;
+    uint8_t msx;                // luma blocks of an MCU
+    uint8_t msy;
+    uint8_t qtid[3];            // of each component
+    uint8_t dcid[3];            // DC and AC Huffman tables of each component
+    uint8_t acid[3];
+    uint16_t nrst;              // restart interval in MCU, 0 if none
+    int32_t dcv[3];             // DC predictors
+    JHUFF huff[2][2];           // [DC, AC][table]
+    int32_t qt[4][64];          // natural order, prescaled for the IDCT
+    uint8_t qt_valid;           // bit of each defined table
+    uint8_t huff_valid;         // bit 2 * class + table of each defined table
+
+    const uint8_t *dptr;        // next byte of inbuf
+    size_t dctr;                // bytes left in inbuf
+    uint32_t bitbuf;            // entropy coded bits, the next in bit 31
+    int8_t bitcnt;
+    uint8_t marker;             // marker that ended the entropy coded data, 0 if none
+
+    uint8_t mcubuf[6][64];      // samples of the blocks of an MCU, luma first
+    uint16_t pixels[16 * 16];   // the MCU in color565
+    uint8_t inbuf[JD_SZBUF];
+};
+
+// Reads the headers up to the first scan, width and height are set after.
+JRESULT jd_prepare(JDEC *jd, jd_infunc_t infunc, void *device);
+
+// Decodes the image scaled down by 1 << scale, scale 0 to 3.
+JRESULT jd_decomp(JDEC *jd, jd_outfunc_t outfunc, uint8_t scale);
+
+#endif
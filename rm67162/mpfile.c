@@ -0,0 +1,46 @@
+#include "mpfile.h"
+
+#include "py/runtime.h"
+#include "py/stream.h"
+#include "py/builtin.h"
+#include "py/mperrno.h"
+
+#include <string.h>
+
+
+mp_obj_t mp_file_open(const char *path, const char *mode) {
+    mp_obj_t args[2] = {
+        mp_obj_new_str(path, strlen(path)),
+        mp_obj_new_str(mode, strlen(mode)),
+    };
+    return mp_call_function_n_kw(MP_OBJ_FROM_PTR(&mp_builtin_open_obj), 2, 0, args);
+}
+
+
+// Reads up to size bytes, fewer only at the end of the file.
+mp_uint_t mp_file_readinto(mp_obj_t file, void *buf, mp_uint_t size) {
+    int errcode = 0;
+    mp_uint_t len = mp_stream_rw(file, buf, size, &errcode, MP_STREAM_RW_READ);
+    if (errcode != 0) {
+        mp_raise_OSError(errcode);
+    }
+    return len;
+}
+
+
+void mp_file_seek(mp_obj_t file, mp_off_t offset, int whence) {
+    const mp_stream_p_t *stream = mp_get_stream_raise(file, MP_STREAM_OP_IOCTL);
+    struct mp_stream_seek_t seek_s;
+    seek_s.offset = offset;
+    seek_s.whence = whence;
+
+    int errcode;
+    if (stream->ioctl(file, MP_STREAM_SEEK, (uintptr_t)&seek_s, &errcode) == MP_STREAM_ERROR) {
+        mp_raise_OSError(errcode);
+    }
+}
+
+
+void mp_file_close(mp_obj_t file) {
+    mp_stream_close(file);
+}
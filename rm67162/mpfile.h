@@ -0,0 +1,13 @@
+#ifndef __MPFILE_H__
+#define __MPFILE_H__
+
+#include "py/obj.h"
+
+// Files of the MicroPython VFS, for the data the driver reads on demand.
+// Errors are raised as OSError.
+mp_obj_t mp_file_open(const char *path, const char *mode);
+mp_uint_t mp_file_readinto(mp_obj_t file, void *buf, mp_uint_t size);
+void mp_file_seek(mp_obj_t file, mp_off_t offset, int whence);
+void mp_file_close(mp_obj_t file);
+
+#endif
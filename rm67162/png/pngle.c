@@ -0,0 +1,651 @@
+#include "pngle.h"
+
+#include <string.h>
+
+
+/*
+Input. Chunks are read a byte at a time from inbuf, which the input function
+refills.
+*/
+
+static int read_byte(pngle_t *png) {
+    if (png->dctr == 0) {
+        png->dctr = png->infunc(png, png->inbuf, PNGLE_SZBUF);
+        png->dptr = png->inbuf;
+        if (png->dctr == 0) {
+            return -1;
+        }
+    }
+    png->dctr--;
+    return *png->dptr++;
+}
+
+
+static bool read_u32(pngle_t *png, uint32_t *v) {
+    *v = 0;
+    for (int i = 0; i < 4; i++) {
+        int c = read_byte(png);
+        if (c < 0) {
+            return false;
+        }
+        *v = (*v << 8) | c;
+    }
+    return true;
+}
+
+
+static bool skip(pngle_t *png, uint32_t len) {
+    while (len--) {
+        if (read_byte(png) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// The next byte of the image data, which continues over IDAT chunks.
+static int idat_byte(pngle_t *png) {
+    while (png->chunk_left == 0) {
+        uint32_t crc, len, type;
+        if (png->idat_end || !read_u32(png, &crc) || !read_u32(png, &len) || !read_u32(png, &type) ||
+            type != 0x49444154) {
+            png->idat_end = true;
+            return -1;
+        }
+        png->chunk_left = len;
+    }
+    png->chunk_left--;
+    return read_byte(png);
+}
+
+
+/*
+Headers.
+*/
+
+static PNGLE_RESULT read_ihdr(pngle_t *png, uint32_t len) {
+    uint8_t b[13];
+    if (len != 13) {
+        return PNGLE_FMT1;
+    }
+    for (int i = 0; i < 13; i++) {
+        int c = read_byte(png);
+        if (c < 0) {
+            return PNGLE_INP;
+        }
+        b[i] = c;
+    }
+    png->width = (uint32_t)b[0] << 24 | b[1] << 16 | b[2] << 8 | b[3];
+    png->height = (uint32_t)b[4] << 24 | b[5] << 16 | b[6] << 8 | b[7];
+    png->depth = b[8];
+    png->color_type = b[9];
+
+    static const uint8_t channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+    if (png->color_type > 6 || channels[png->color_type] == 0) {
+        return PNGLE_FMT1;
+    }
+    png->channels = channels[png->color_type];
+
+    // 1, 2, 4 bits for gray and palette, 8 for all, 16 for all but palette
+    uint8_t d = png->depth;
+    bool low = d == 1 || d == 2 || d == 4;
+    if (!((d == 8) || (d == 16 && png->color_type != 3) || (low && (png->color_type == 0 || png->color_type == 3)))) {
+        return PNGLE_FMT1;
+    }
+    if (png->width == 0 || png->height == 0 || png->width > 0x10000 || b[10] != 0 || b[11] != 0) {
+        return PNGLE_FMT3;
+    }
+    if (b[12] != 0) {
+        return PNGLE_FMT3;
+    }
+    png->line_size = ((size_t)png->width * png->channels * png->depth + 7) / 8 + 1;
+    return PNGLE_OK;
+}
+
+
+static PNGLE_RESULT read_plte(pngle_t *png, uint32_t len) {
+    if (len % 3 || len > 256 * 3) {
+        return PNGLE_FMT1;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        int c = read_byte(png);
+        if (c < 0) {
+            return PNGLE_INP;
+        }
+        png->palette[(i / 3) * 4 + i % 3] = c;
+    }
+    return PNGLE_OK;
+}
+
+
+static PNGLE_RESULT read_trns(pngle_t *png, uint32_t len) {
+    if (png->color_type == 3) {
+        if (len > 256) {
+            return PNGLE_FMT1;
+        }
+        for (uint32_t i = 0; i < len; i++) {
+            int c = read_byte(png);
+            if (c < 0) {
+                return PNGLE_INP;
+            }
+            png->palette[i * 4 + 3] = c;
+        }
+        return PNGLE_OK;
+    }
+    if (png->channels == 2 || png->channels == 4 || len != 2u * png->channels) {
+        return skip(png, len) ? PNGLE_OK : PNGLE_INP;
+    }
+    for (int i = 0; i < png->channels; i++) {
+        int hi = read_byte(png);
+        int lo = read_byte(png);
+        if (hi < 0 || lo < 0) {
+            return PNGLE_INP;
+        }
+        png->trns[i] = hi << 8 | lo;
+    }
+    png->has_trns = true;
+    return PNGLE_OK;
+}
+
+
+PNGLE_RESULT pngle_prepare(pngle_t *png, pngle_infunc_t infunc, void *device) {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    png->infunc = infunc;
+    png->device = device;
+    png->dctr = 0;
+    png->width = 0;
+    png->has_trns = false;
+    for (int i = 0; i < 256; i++) {
+        png->palette[i * 4] = png->palette[i * 4 + 1] = png->palette[i * 4 + 2] = 0;
+        png->palette[i * 4 + 3] = 0xFF;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        if (read_byte(png) != signature[i]) {
+            return PNGLE_INP;
+        }
+    }
+
+    for (;;) {
+        uint32_t len, type;
+        if (!read_u32(png, &len) || !read_u32(png, &type)) {
+            return PNGLE_INP;
+        }
+
+        PNGLE_RESULT res = PNGLE_OK;
+        switch (type) {
+            case 0x49484452:            // IHDR
+                res = read_ihdr(png, len);
+                break;
+
+            case 0x504C5445:            // PLTE
+                res = read_plte(png, len);
+                break;
+
+            case 0x74524E53:            // tRNS
+                res = read_trns(png, len);
+                break;
+
+            case 0x49444154: {          // IDAT, the zlib header starts the data
+                if (png->width == 0) {
+                    return PNGLE_FMT1;
+                }
+                png->chunk_left = len;
+                png->idat_end = false;
+                int cmf = idat_byte(png);
+                int flg = idat_byte(png);
+                if (cmf < 0 || flg < 0) {
+                    return PNGLE_INP;
+                }
+                if ((cmf & 15) != 8 || (cmf >> 4) > 7 || (cmf << 8 | flg) % 31 || (flg & 0x20)) {
+                    return PNGLE_FMT1;
+                }
+                png->window_size = (size_t)1 << ((cmf >> 4) + 8);
+                return PNGLE_OK;
+            }
+
+            case 0x49454E44:            // IEND
+                return PNGLE_FMT1;
+
+            default:
+                res = skip(png, len) ? PNGLE_OK : PNGLE_INP;
+                break;
+        }
+        if (res != PNGLE_OK) {
+            return res;
+        }
+        // CRC
+        if (!skip(png, 4)) {
+            return PNGLE_INP;
+        }
+    }
+}
+
+
+/*
+Scanlines. Inflated bytes go into the window and the current scanline, a full
+scanline is unfiltered against the previous one and converted to RGBA.
+*/
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = a + b - c;
+    int pa = p > a ? p - a : a - p;
+    int pb = p > b ? p - b : b - p;
+    int pc = p > c ? p - c : c - p;
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+}
+
+
+static PNGLE_RESULT unfilter(pngle_t *png) {
+    uint8_t *cur = png->cur + 1;
+    const uint8_t *prev = png->prev + 1;
+    size_t n = png->line_size - 1;
+    size_t bpp = (png->channels * png->depth + 7) / 8;
+
+    switch (png->cur[0]) {
+        case 0:
+            break;
+        case 1:
+            for (size_t i = bpp; i < n; i++) {
+                cur[i] += cur[i - bpp];
+            }
+            break;
+        case 2:
+            for (size_t i = 0; i < n; i++) {
+                cur[i] += prev[i];
+            }
+            break;
+        case 3:
+            for (size_t i = 0; i < n; i++) {
+                cur[i] += ((i >= bpp ? cur[i - bpp] : 0) + prev[i]) >> 1;
+            }
+            break;
+        case 4:
+            for (size_t i = 0; i < n; i++) {
+                cur[i] += (i >= bpp) ? paeth(cur[i - bpp], prev[i], prev[i - bpp]) : prev[i];
+            }
+            break;
+        default:
+            return PNGLE_FMT1;
+    }
+    return PNGLE_OK;
+}
+
+
+// Sample x of a row of samples of depth bits.
+static uint16_t sample(const uint8_t *row, size_t x, uint8_t depth) {
+    switch (depth) {
+        case 16:
+            return row[2 * x] << 8 | row[2 * x + 1];
+        case 8:
+            return row[x];
+        default: {
+            size_t bit = x * depth;
+            return (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1 << depth) - 1);
+        }
+    }
+}
+
+
+static void to_rgba(pngle_t *png) {
+    const uint8_t *row = png->cur + 1;
+    uint8_t *out = png->rgba;
+    uint8_t depth = png->depth;
+    // samples scaled to 8 bits, 16 bit ones keep the high byte
+    uint16_t max = (1 << depth) - 1;
+
+    for (uint32_t x = 0; x < png->width; x++, out += 4) {
+        uint16_t s[4];
+        for (int c = 0; c < png->channels; c++) {
+            s[c] = sample(row, (size_t)x * png->channels + c, depth);
+        }
+        uint8_t v[4];
+        for (int c = 0; c < png->channels; c++) {
+            v[c] = (depth == 16) ? s[c] >> 8 : (depth == 8) ? s[c] : s[c] * 255 / max;
+        }
+
+        switch (png->color_type) {
+            case 0:
+                out[0] = out[1] = out[2] = v[0];
+                out[3] = (png->has_trns && s[0] == png->trns[0]) ? 0 : 0xFF;
+                break;
+            case 2:
+                out[0] = v[0];
+                out[1] = v[1];
+                out[2] = v[2];
+                out[3] = (png->has_trns && s[0] == png->trns[0] && s[1] == png->trns[1] && s[2] == png->trns[2]) ? 0 : 0xFF;
+                break;
+            case 3:
+                memcpy(out, &png->palette[s[0] * 4], 4);
+                break;
+            case 4:
+                out[0] = out[1] = out[2] = v[0];
+                out[3] = v[1];
+                break;
+            case 6:
+                memcpy(out, v, 4);
+                break;
+        }
+    }
+}
+
+
+// Appends an inflated byte, returns PNGLE_INTR to stop after the last row.
+static PNGLE_RESULT put(pngle_t *png, uint8_t b) {
+    png->window[png->wpos++ & (png->window_size - 1)] = b;
+    png->cur[png->lpos++] = b;
+    if (png->lpos < png->line_size) {
+        return PNGLE_OK;
+    }
+
+    png->lpos = 0;
+    PNGLE_RESULT res = unfilter(png);
+    if (res != PNGLE_OK) {
+        return res;
+    }
+    to_rgba(png);
+    if (!png->outfunc(png, png->y, png->rgba) || ++png->y == png->height) {
+        return PNGLE_INTR;
+    }
+    uint8_t *t = png->prev;
+    png->prev = png->cur;
+    png->cur = t;
+    return PNGLE_OK;
+}
+
+
+/*
+Inflate, RFC 1951.
+*/
+
+static void fill_bits(pngle_t *png) {
+    while (png->bitcnt <= 24) {
+        int c = idat_byte(png);
+        if (c < 0) {
+            if (png->overrun < 0xFF) {
+                png->overrun++;
+            }
+            c = 0;
+        }
+        png->bitbuf |= (uint32_t)c << png->bitcnt;
+        png->bitcnt += 8;
+    }
+}
+
+
+static uint32_t get_bits(pngle_t *png, int n) {
+    fill_bits(png);
+    uint32_t v = png->bitbuf & ((1u << n) - 1);
+    png->bitbuf >>= n;
+    png->bitcnt -= n;
+    return v;
+}
+
+
+// Builds the canonical code of n lengths, false if over-subscribed.
+static bool build(pngle_huff_t *h, const uint8_t *lengths, int n) {
+    uint16_t offs[16];
+    memset(h->count, 0, sizeof(h->count));
+    for (int i = 0; i < n; i++) {
+        h->count[lengths[i]]++;
+    }
+    h->count[0] = 0;
+
+    int left = 1;
+    for (int len = 1; len < 16; len++) {
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0) {
+            return false;
+        }
+    }
+
+    offs[1] = 0;
+    for (int len = 1; len < 15; len++) {
+        offs[len + 1] = offs[len] + h->count[len];
+    }
+    for (int i = 0; i < n; i++) {
+        if (lengths[i]) {
+            h->symbol[offs[lengths[i]]++] = i;
+        }
+    }
+
+    // codes are sent from their first bit, the lookup is indexed bit reversed
+    memset(h->lookup, 0, sizeof(h->lookup));
+    int code = 0;
+    int index = 0;
+    for (int len = 1; len <= PNGLE_LOOKUP_BITS; len++) {
+        for (int i = 0; i < h->count[len]; i++, code++, index++) {
+            int rev = 0;
+            for (int b = 0; b < len; b++) {
+                rev |= ((code >> b) & 1) << (len - 1 - b);
+            }
+            for (int j = rev; j < (1 << PNGLE_LOOKUP_BITS); j += 1 << len) {
+                h->lookup[j] = len << 9 | h->symbol[index];
+            }
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+
+// The next symbol, -1 for an invalid code.
+static int decode(pngle_t *png, const pngle_huff_t *h) {
+    fill_bits(png);
+    uint16_t e = h->lookup[png->bitbuf & ((1 << PNGLE_LOOKUP_BITS) - 1)];
+    if (e) {
+        png->bitbuf >>= e >> 9;
+        png->bitcnt -= e >> 9;
+        return e & 0x1FF;
+    }
+
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len < 16; len++) {
+        code |= (png->bitbuf >> (len - 1)) & 1;
+        int count = h->count[len];
+        if (code - count < first) {
+            png->bitbuf >>= len;
+            png->bitcnt -= len;
+            return h->symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+
+static PNGLE_RESULT inflate_stored(pngle_t *png) {
+    // the rest of the byte, the bytes after are still in bitbuf
+    get_bits(png, png->bitcnt & 7);
+    uint32_t len = get_bits(png, 16);
+    if ((get_bits(png, 16) ^ 0xFFFF) != len) {
+        return PNGLE_FMT1;
+    }
+    while (len--) {
+        PNGLE_RESULT res = put(png, get_bits(png, 8));
+        if (res != PNGLE_OK) {
+            return res;
+        }
+    }
+    return (png->overrun > 4) ? PNGLE_INP : PNGLE_OK;
+}
+
+
+static PNGLE_RESULT inflate_codes(pngle_t *png) {
+    static const uint16_t len_base[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+    };
+    static const uint8_t len_extra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+    };
+    static const uint16_t dist_base[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+    };
+    static const uint8_t dist_extra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+    };
+
+    for (;;) {
+        int sym = decode(png, &png->lit);
+        if (sym < 0 || png->overrun > 4) {
+            return (sym < 0) ? PNGLE_FMT1 : PNGLE_INP;
+        }
+        if (sym < 256) {
+            PNGLE_RESULT res = put(png, sym);
+            if (res != PNGLE_OK) {
+                return res;
+            }
+            continue;
+        }
+        if (sym == 256) {
+            return PNGLE_OK;
+        }
+
+        sym -= 257;
+        if (sym >= 29) {
+            return PNGLE_FMT1;
+        }
+        uint32_t len = len_base[sym] + get_bits(png, len_extra[sym]);
+        int d = decode(png, &png->dist);
+        if (d < 0 || d >= 30) {
+            return PNGLE_FMT1;
+        }
+        uint32_t dist = dist_base[d] + get_bits(png, dist_extra[d]);
+        if (dist > png->window_size || dist > png->wpos) {
+            return PNGLE_FMT1;
+        }
+        while (len--) {
+            PNGLE_RESULT res = put(png, png->window[(png->wpos - dist) & (png->window_size - 1)]);
+            if (res != PNGLE_OK) {
+                return res;
+            }
+        }
+    }
+}
+
+
+static PNGLE_RESULT inflate_fixed(pngle_t *png) {
+    uint8_t lengths[288];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    build(&png->lit, lengths, 288);
+    memset(lengths, 5, 30);
+    build(&png->dist, lengths, 30);
+    return inflate_codes(png);
+}
+
+
+static PNGLE_RESULT inflate_dynamic(pngle_t *png) {
+    static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    uint8_t lengths[288 + 32];
+
+    int nlen = get_bits(png, 5) + 257;
+    int ndist = get_bits(png, 5) + 1;
+    int ncode = get_bits(png, 4) + 4;
+    if (nlen > 286 || ndist > 30) {
+        return PNGLE_FMT1;
+    }
+
+    // the code length code is built in the distance table
+    memset(lengths, 0, 19);
+    for (int i = 0; i < ncode; i++) {
+        lengths[order[i]] = get_bits(png, 3);
+    }
+    if (!build(&png->dist, lengths, 19)) {
+        return PNGLE_FMT1;
+    }
+
+    for (int i = 0; i < nlen + ndist;) {
+        int sym = decode(png, &png->dist);
+        if (sym < 0) {
+            return PNGLE_FMT1;
+        }
+        if (sym < 16) {
+            lengths[i++] = sym;
+            continue;
+        }
+        uint8_t len = 0;
+        int repeat;
+        if (sym == 16) {
+            if (i == 0) {
+                return PNGLE_FMT1;
+            }
+            len = lengths[i - 1];
+            repeat = 3 + get_bits(png, 2);
+        } else if (sym == 17) {
+            repeat = 3 + get_bits(png, 3);
+        } else {
+            repeat = 11 + get_bits(png, 7);
+        }
+        if (i + repeat > nlen + ndist) {
+            return PNGLE_FMT1;
+        }
+        while (repeat--) {
+            lengths[i++] = len;
+        }
+    }
+
+    if (lengths[256] == 0 || !build(&png->lit, lengths, nlen) || !build(&png->dist, lengths + nlen, ndist)) {
+        return PNGLE_FMT1;
+    }
+    return inflate_codes(png);
+}
+
+
+PNGLE_RESULT pngle_decode(pngle_t *png, pngle_outfunc_t outfunc) {
+    png->outfunc = outfunc;
+    png->bitbuf = 0;
+    png->bitcnt = 0;
+    png->overrun = 0;
+    png->wpos = 0;
+    png->lpos = 0;
+    png->y = 0;
+    png->cur = png->lines;
+    png->prev = png->lines + png->line_size;
+    memset(png->prev, 0, png->line_size);
+
+    for (;;) {
+        int last = get_bits(png, 1);
+        int type = get_bits(png, 2);
+        PNGLE_RESULT res;
+        switch (type) {
+            case 0:
+                res = inflate_stored(png);
+                break;
+            case 1:
+                res = inflate_fixed(png);
+                break;
+            case 2:
+                res = inflate_dynamic(png);
+                break;
+            default:
+                res = PNGLE_FMT1;
+                break;
+        }
+
+        // the last row ends the image, data after it is not read
+        if (res == PNGLE_INTR) {
+            return (png->y == png->height) ? PNGLE_OK : PNGLE_INTR;
+        }
+        if (res != PNGLE_OK) {
+            return res;
+        }
+        if (last) {
+            return PNGLE_INP;
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef __PNGLE_H__
+#define __PNGLE_H__
+
+/*
+Streaming PNG decoder.
+
+The image is read through an input function, inflated and unfiltered one
+scanline at a time, and each row is handed to an output function as RGBA8888.
+Memory is the LZ77 window the zlib header asks for, at most 32 KB, two
+scanlines and one RGBA row, all provided by the caller after pngle_prepare().
+All color types and bit depths are supported, with tRNS transparency.
+Interlaced images are not. Checksums are not verified.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define PNGLE_SZBUF         512     // bytes of the input buffer
+#define PNGLE_LOOKUP_BITS   9       // Huffman codes up to this length are looked up at once
+
+typedef enum {
+    PNGLE_OK = 0,       // succeeded
+    PNGLE_INTR,         // interrupted by the output function
+    PNGLE_INP,          // the input ended or is not a PNG stream
+    PNGLE_FMT1,         // data format error, the stream may be damaged
+    PNGLE_FMT3,         // not supported, e.g. interlaced
+} PNGLE_RESULT;
+
+typedef struct {
+    uint16_t lookup[1 << PNGLE_LOOKUP_BITS];    // length << 9 | symbol, 0 for longer codes
+    uint16_t count[16];                         // codes of each length
+    uint16_t symbol[288];                       // in canonical order
+} pngle_huff_t;
+
+typedef struct pngle pngle_t;
+
+// Reads up to len bytes into buf, returns the bytes read, 0 at the end.
+typedef size_t (*pngle_infunc_t)(pngle_t *png, uint8_t *buf, size_t len);
+
+// Takes row y of width RGBA pixel. Returns 0 to stop.
+typedef int (*pngle_outfunc_t)(pngle_t *png, uint32_t y, const uint8_t *rgba);
+
+struct pngle {
+    pngle_infunc_t infunc;
+    void *device;               // for the input and output functions
+    uint32_t width;
+    uint32_t height;
+    uint8_t depth;              // bits of a sample
+    uint8_t color_type;
+    uint8_t channels;
+    bool has_trns;
+    uint16_t trns[3];           // transparent gray or RGB sample
+    uint8_t palette[256 * 4];   // RGBA, alpha from tRNS
+
+    size_t window_size;         // bytes the caller provides in window
+    size_t line_size;           // bytes of a scanline with its filter byte
+    uint8_t *window;            // LZ77 window, window_size bytes
+    uint8_t *lines;             // two scanlines, 2 * line_size bytes
+    uint8_t *rgba;              // one row, 4 * width bytes
+
+    // input, IDAT chunks are read as one stream
+    const uint8_t *dptr;
+    size_t dctr;
+    uint32_t chunk_left;
+    bool idat_end;
+    uint32_t bitbuf;            // deflate bits, the next in bit 0
+    int8_t bitcnt;
+    uint8_t overrun;            // bytes read past the end of the data
+
+    // output
+    size_t wpos;                // bytes inflated so far
+    size_t lpos;                // in the current scanline
+    uint32_t y;
+    uint8_t *cur;
+    uint8_t *prev;
+    pngle_outfunc_t outfunc;
+
+    pngle_huff_t lit;
+    pngle_huff_t dist;
+    uint8_t inbuf[PNGLE_SZBUF];
+};
+
+// Reads the chunks up to the image data, the fields up to rgba are set after.
+PNGLE_RESULT pngle_prepare(pngle_t *png, pngle_infunc_t infunc, void *device);
+
+// Decodes the image into the window, lines and rgba buffers set by the caller.
+PNGLE_RESULT pngle_decode(pngle_t *png, pngle_outfunc_t outfunc);
+
+#endif
@@ -6,11 +6,18 @@
 #include "mphalport.h"
 #include "py/gc.h"
 #include "py/objstr.h"
+#include "py/objarray.h"
+#include "py/stream.h"
+#include "mpfile.h"
+#include "jpg/tjpgd565.h"
+#include "png/pngle.h"
 
 #include "esp_lcd_panel_io.h"
+#include "esp_heap_caps.h"
 #include "driver/spi_master.h"
 
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 
 #define RM67162_DRIVER_VERSION "0.0.2"
@@ -26,7 +33,6 @@
 #define ABS(N) (((N) < 0) ? (-(N)) : (N))
 #define mp_hal_delay_ms(delay) (mp_hal_delay_us(delay * 1000))
 
-#define MAX_BUFFER_SIZE_IN_PIXEL  4288 // 536 * 8 = 4288
 
 const char* color_space_desc[] = {
     "RGB",
@@ -59,15 +65,62 @@ Below are transmission related functions.
 -----------------------------------------------------------------------------------------------------*/
 
 
+// Writes at the ram pointer left by set_area() or by the previous write.
 STATIC void write_color(rm67162_RM67162_obj_t *self, const void *buf, int len) {
     if (self->lcd_panel_p) {
-            self->lcd_panel_p->tx_color(self->bus_obj, 0, buf, len);
+            self->lcd_panel_p->tx_color(self->bus_obj, self->ramwr_cmd, buf, len);
+            self->ramwr_cmd = LCD_CMD_RAMWRC;
+            self->window_pos += len / (self->fb_bpp / 8);
     } else {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to find the panel object."));
     }
 }
 
 
+// buf must not be modified until wait_color() returns.
+STATIC void write_color_async(rm67162_RM67162_obj_t *self, const void *buf, int len) {
+    if (self->lcd_panel_p) {
+            self->lcd_panel_p->tx_color_async(self->bus_obj, self->ramwr_cmd, buf, len);
+            self->ramwr_cmd = LCD_CMD_RAMWRC;
+            self->window_pos += len / (self->fb_bpp / 8);
+    } else {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to find the panel object."));
+    }
+}
+
+
+// Sends len bytes repeating the block buf of size bytes.
+STATIC void write_color_repeat(rm67162_RM67162_obj_t *self, const void *buf, int size, int len) {
+    if (self->lcd_panel_p && self->lcd_panel_p->tx_color_repeat) {
+        self->lcd_panel_p->tx_color_repeat(self->bus_obj, self->ramwr_cmd, buf, size, len);
+        self->ramwr_cmd = LCD_CMD_RAMWRC;
+        self->window_pos += len / (self->fb_bpp / 8);
+    } else {
+        while (len > 0) {
+            write_color(self, buf, MIN(size, len));
+            len -= size;
+        }
+    }
+}
+
+
+STATIC void wait_color(rm67162_RM67162_obj_t *self) {
+    if (self->lcd_panel_p) {
+        self->lcd_panel_p->wait(self->bus_obj);
+    }
+    self->tx_obj = MP_OBJ_NULL;
+}
+
+
+STATIC void read_spi(rm67162_RM67162_obj_t *self, int cmd, void *buf, int len) {
+    if (self->lcd_panel_p && self->lcd_panel_p->rx_param) {
+        self->lcd_panel_p->rx_param(self->bus_obj, cmd, buf, len);
+    } else {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("The panel bus cannot read."));
+    }
+}
+
+
 STATIC void write_spi(rm67162_RM67162_obj_t *self, int cmd, const void *buf, int len) {
     if (self->lcd_panel_p) {
             self->lcd_panel_p->tx_param(self->bus_obj, cmd, buf, len);
@@ -77,6 +130,26 @@ STATIC void write_spi(rm67162_RM67162_obj_t *self, int cmd, const void *buf, int
 }
 
 
+// Forget the shadowed registers, e.g. after a reset or a raw command.
+STATIC void invalidate_registers(rm67162_RM67162_obj_t *self) {
+    self->madctl_sent = -1;
+    self->window_valid = false;
+    self->ramwr_cmd = LCD_CMD_RAMWR;
+}
+
+
+// Sends madctl_val if it differs from the panel register. The address
+// mapping changes with it, so the window has to be set again.
+STATIC void write_madctl(rm67162_RM67162_obj_t *self) {
+    if (self->madctl_sent != self->madctl_val) {
+        write_spi(self, LCD_CMD_MADCTL, (uint8_t[]) { self->madctl_val }, 1);
+        self->madctl_sent = self->madctl_val;
+        self->window_valid = false;
+        self->ramwr_cmd = LCD_CMD_RAMWR;
+    }
+}
+
+
 /*----------------------------------------------------------------------------------------------------
 Below are initialization related functions.
 -----------------------------------------------------------------------------------------------------*/
@@ -95,11 +168,169 @@ STATIC void frame_buffer_alloc(rm67162_RM67162_obj_t *self, int len) {
 }
 
 
+/*
+Scratch arena. Primitives borrow their temporary buffers from one DMA capable
+block allocated with the object: half of it is a large slot for streamed
+fills and glyphs, the rest RM67162_SCRATCH_SMALL small slots. Requests that do
+not fit, or find their slots taken, fall back to the heap with the least size
+they accept and are counted. A borrower that can raise holds its slot under
+nlr_push() and returns it before the exception propagates.
+*/
+
+STATIC void scratch_alloc(rm67162_RM67162_obj_t *self, size_t size) {
+    // every slot stays word aligned
+    size &= ~(size_t)(RM67162_SCRATCH_SMALL * 8 - 1);
+    self->scratch = NULL;
+    self->scratch_size = 0;
+    self->scratch_used = 0;
+    if (size) {
+        self->scratch = heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (self->scratch == NULL) {
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate DMA'able scratch buffer."));
+        }
+        self->scratch_size = size;
+    }
+}
+
+
+// Borrows at least min and up to *size bytes, *size is set to what was granted.
+STATIC void *scratch_get(rm67162_RM67162_obj_t *self, size_t min, size_t *size) {
+    size_t large = self->scratch_size / 2;
+    size_t small = large / RM67162_SCRATCH_SMALL;
+
+    if (self->scratch && *size <= small) {
+        for (int i = 1; i <= RM67162_SCRATCH_SMALL; i++) {
+            if (!(self->scratch_used & (1 << i))) {
+                self->scratch_used |= 1 << i;
+                return self->scratch + large + (i - 1) * small;
+            }
+        }
+    }
+    if (self->scratch && min <= large && !(self->scratch_used & 1)) {
+        self->scratch_used |= 1;
+        if (*size > large) {
+            *size = large;
+        }
+        return self->scratch;
+    }
+
+    self->stat_allocs++;
+    *size = min;
+    return m_malloc(min);
+}
+
+
+STATIC void scratch_put(rm67162_RM67162_obj_t *self, void *buf) {
+    uint8_t *p = buf;
+    if (self->scratch && p >= self->scratch && p < self->scratch + self->scratch_size) {
+        size_t large = self->scratch_size / 2;
+        int slot = (p < self->scratch + large) ? 0 : 1 + (p - self->scratch - large) / (large / RM67162_SCRATCH_SMALL);
+        self->scratch_used &= ~(1 << slot);
+    } else {
+        m_free(buf);
+    }
+}
+
+
+/*
+Glyph cache. text() and write() keep glyphs expanded to color565 in entries
+of up to glyph_budget bytes in total, keyed by font, glyph and colors. When
+the budget or the RM67162_GLYPH_SLOTS entries run out, the least recently used
+glyph is dropped, except those used by the current call, see glyph_cache_begin().
+*/
+
+STATIC void glyph_cache_alloc(rm67162_RM67162_obj_t *self, size_t budget) {
+    self->glyphs = (budget) ? m_new(rm67162_glyph_t, RM67162_GLYPH_SLOTS) : NULL;
+    self->glyph_count = 0;
+    self->glyph_budget = budget;
+    self->glyph_bytes = 0;
+    self->glyph_tick = 0;
+}
+
+
+STATIC void glyph_cache_free(rm67162_RM67162_obj_t *self) {
+    for (int i = 0; i < self->glyph_count; i++) {
+        m_free(self->glyphs[i].pixels);
+    }
+    m_free(self->glyphs);
+    glyph_cache_alloc(self, 0);
+}
+
+
+// Starts a text() or write() call, the glyphs it uses are not dropped before
+// it returns.
+STATIC void glyph_cache_begin(rm67162_RM67162_obj_t *self) {
+    self->glyph_tick++;
+}
+
+
+// The pixels of a cached glyph, NULL if it is not cached.
+STATIC const uint16_t *glyph_cache_find(rm67162_RM67162_obj_t *self, mp_obj_t font, uint32_t glyph, uint16_t fg, uint16_t bg) {
+    for (int i = 0; i < self->glyph_count; i++) {
+        rm67162_glyph_t *g = &self->glyphs[i];
+        if (g->glyph == glyph && g->font == font && g->fg == fg && g->bg == bg) {
+            g->used = self->glyph_tick;
+            self->stat_glyph_hits++;
+            return g->pixels;
+        }
+    }
+    self->stat_glyph_misses++;
+    return NULL;
+}
+
+
+// Adds an entry of w * h pixels for the caller to fill, NULL if it does not
+// fit without dropping glyphs of the current call.
+STATIC uint16_t *glyph_cache_add(rm67162_RM67162_obj_t *self, mp_obj_t font, uint32_t glyph, uint16_t fg, uint16_t bg, int w, int h) {
+    size_t size = w * h * 2;
+    if (self->glyphs == NULL || size > self->glyph_budget) {
+        return NULL;
+    }
+
+    while (self->glyph_count == RM67162_GLYPH_SLOTS || self->glyph_bytes + size > self->glyph_budget) {
+        int lru = -1;
+        for (int i = 0; i < self->glyph_count; i++) {
+            if (self->glyphs[i].used != self->glyph_tick &&
+                (lru < 0 || (int32_t)(self->glyphs[i].used - self->glyphs[lru].used) < 0)) {
+                lru = i;
+            }
+        }
+        if (lru < 0) {
+            return NULL;
+        }
+        m_free(self->glyphs[lru].pixels);
+        self->glyph_bytes -= self->glyphs[lru].width * self->glyphs[lru].height * 2;
+        self->glyphs[lru] = self->glyphs[--self->glyph_count];
+    }
+
+    uint16_t *pixels = m_malloc_maybe(size);
+    if (pixels == NULL) {
+        return NULL;
+    }
+    rm67162_glyph_t *g = &self->glyphs[self->glyph_count++];
+    g->font = font;
+    g->glyph = glyph;
+    g->fg = fg;
+    g->bg = bg;
+    g->width = w;
+    g->height = h;
+    g->used = self->glyph_tick;
+    g->pixels = pixels;
+    self->glyph_bytes += size;
+    return pixels;
+}
+
+
+STATIC void dirty_mark_all(rm67162_RM67162_obj_t *self);
+
+
 STATIC void set_rotation(rm67162_RM67162_obj_t *self, uint8_t rotation) {
     self->madctl_val &= 0x1F;
     self->madctl_val |= self->rotations[rotation].madctl;
 
-    write_spi(self, LCD_CMD_MADCTL, (uint8_t[]) { self->madctl_val }, 1);
+    write_madctl(self);
+    // the rows are opened up to max_height_value, which depends on the rotation
+    self->window_valid = false;
 
     self->width = self->rotations[rotation].width;
     self->max_width_value = self->width - 1;
@@ -107,6 +338,14 @@ STATIC void set_rotation(rm67162_RM67162_obj_t *self, uint8_t rotation) {
     self->max_height_value = self->height - 1;
     self->x_gap = self->rotations[rotation].colstart;
     self->y_gap = self->rotations[rotation].rowstart;
+
+    // the tile count is the same in every rotation, only the stride changes
+    if (self->dirty_tiles) {
+        self->tiles_x = (self->width + (1 << RM67162_TILE_SHIFT) - 1) >> RM67162_TILE_SHIFT;
+        self->tiles_y = (self->height + (1 << RM67162_TILE_SHIFT) - 1) >> RM67162_TILE_SHIFT;
+        dirty_mark_all(self);
+    }
+    self->shadow_valid = false;
 }
 
 
@@ -139,7 +378,11 @@ mp_obj_t rm67162_RM67162_make_new(const mp_obj_type_t *type,
         ARG_reset_level,
         ARG_color_space,
         ARG_bpp,
-        ARG_use_frame_buffer
+        ARG_use_frame_buffer,
+        ARG_frame_diff,
+        ARG_double_buffer,
+        ARG_scratch_size,
+        ARG_glyph_cache
     };
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_bus,               MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}     },
@@ -148,6 +391,10 @@ mp_obj_t rm67162_RM67162_make_new(const mp_obj_type_t *type,
         { MP_QSTR_color_space,       MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = COLOR_SPACE_RGB} },
         { MP_QSTR_BPP,               MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 16}              },
         { MP_QSTR_use_frame_buffer,  MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_bool = false}          },
+        { MP_QSTR_frame_diff,        MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}          },
+        { MP_QSTR_double_buffer,     MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}          },
+        { MP_QSTR_scratch_size,      MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = RM67162_SCRATCH_SIZE} },
+        { MP_QSTR_glyph_cache,       MP_ARG_INT | MP_ARG_KW_ONLY,  {.u_int = 0}               },
     };
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
     mp_arg_parse_all_kw_array(
@@ -159,9 +406,10 @@ mp_obj_t rm67162_RM67162_make_new(const mp_obj_type_t *type,
         args
     );
 
-    // create new object
-    rm67162_RM67162_obj_t *self = m_new_obj(rm67162_RM67162_obj_t);
+    // create new object, __del__ returns the scratch arena
+    rm67162_RM67162_obj_t *self = m_new_obj_with_finaliser(rm67162_RM67162_obj_t);
     self->base.type = &rm67162_RM67162_type;
+    self->scratch = NULL;
 
     self->bus_obj = (mp_obj_base_t *)MP_OBJ_TO_PTR(args[ARG_bus].u_obj);
 #ifdef MP_OBJ_TYPE_GET_SLOT
@@ -171,15 +419,72 @@ mp_obj_t rm67162_RM67162_make_new(const mp_obj_type_t *type,
 #endif
 
     // self->max_width_value etc will be initialized in the rotation later.
-    self->width = ((rm67162_qspi_bus_obj_t *)self->bus_obj)->width;
-    self->height = ((rm67162_qspi_bus_obj_t *)self->bus_obj)->height;
-
+    if (self->lcd_panel_p == NULL || self->lcd_panel_p->get_size == NULL) {
+        mp_raise_TypeError(MP_ERROR_TEXT("bus does not implement the panel protocol"));
+    }
+    self->lcd_panel_p->get_size(self->bus_obj, &self->width, &self->height);
+
+    self->tx_obj = MP_OBJ_NULL;
+    invalidate_registers(self);
+    self->batch_depth = 0;
+    self->batch_len = 0;
+    self->batch_line_len = (self->width > self->height) ? self->width : self->height;
+    self->batch_line = m_malloc(self->batch_line_len * 2);
+    self->batch_line_fill = 0;
+    glyph_cache_alloc(self, args[ARG_glyph_cache].u_int);
+    memset(self->font_index, 0, sizeof(self->font_index));
+    self->font_index_next = 0;
     self->use_frame_buffer = args[ARG_use_frame_buffer].u_bool;
 
     if (self->use_frame_buffer) {
+        if (args[ARG_bpp].u_int != 16) {
+            mp_raise_ValueError(MP_ERROR_TEXT("frame buffer requires BPP=16"));
+        }
         // 2 bytes for each pixel. so maximum will be width * height * 2
         frame_buffer_alloc(self, self->width * self->height * 2);
+        size_t tiles = ((self->width + (1 << RM67162_TILE_SHIFT) - 1) >> RM67162_TILE_SHIFT) *
+                       ((self->height + (1 << RM67162_TILE_SHIFT) - 1) >> RM67162_TILE_SHIFT);
+        self->dirty_tiles = m_malloc(((tiles + 31) / 32) * 4);
+        self->flush_buf = m_malloc(RM67162_FLUSH_BUF_SIZE);
+        self->shadow_buffer = NULL;
+        self->front_buffer = NULL;
+        if (args[ARG_frame_diff].u_bool && args[ARG_double_buffer].u_bool) {
+            mp_raise_ValueError(MP_ERROR_TEXT("frame_diff and double_buffer cannot be combined"));
+        }
+        if (args[ARG_double_buffer].u_bool) {
+            self->front_buffer = gc_alloc(self->frame_buffer_size, 0);
+            if (self->front_buffer == NULL) {
+                mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate second framebuffer."));
+            }
+            memset(self->front_buffer, 0, self->frame_buffer_size);
+        }
+        if (args[ARG_frame_diff].u_bool) {
+            self->shadow_buffer = gc_alloc(self->frame_buffer_size, 0);
+            if (self->shadow_buffer == NULL) {
+                mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate shadow framebuffer."));
+            }
+        }
+    } else {
+        self->frame_buffer = NULL;
+        self->frame_buffer_size = 0;
+        self->dirty_tiles = NULL;
+        self->flush_buf = NULL;
+        self->shadow_buffer = NULL;
+        self->front_buffer = NULL;
     }
+    self->shadow_valid = false;
+    self->stat_shows = 0;
+    self->stat_rects = 0;
+    self->stat_dirty_bytes = 0;
+    self->stat_skipped_bytes = 0;
+    self->stat_missed = 0;
+    self->stat_allocs = 0;
+    self->stat_glyph_hits = 0;
+    self->stat_glyph_misses = 0;
+    self->te_enabled = false;
+    self->te_pin = MP_OBJ_NULL;
+    self->frame_period_us = 0;
+    self->frame_deadline = 0;
     
     self->reset       = args[ARG_reset].u_obj;
     self->reset_level = args[ARG_reset_level].u_bool;
@@ -227,6 +532,9 @@ mp_obj_t rm67162_RM67162_make_new(const mp_obj_type_t *type,
         break;
     }
 
+    // last, nothing raises once the arena is taken outside the gc heap
+    scratch_alloc(self, args[ARG_scratch_size].u_int);
+
     bzero(&self->rotations, sizeof(self->rotations));
     if ((self->width == 240 && self->height == 536) || \
         (self->width == 536 && self->height == 240)) {
@@ -257,6 +565,29 @@ STATIC mp_obj_t rm67162_RM67162_version()
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(rm67162_RM67162_version_obj, rm67162_RM67162_version);
 
 
+STATIC mp_obj_t rm67162_RM67162_wait(mp_obj_t self_in)
+{
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    wait_color(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_wait_obj, rm67162_RM67162_wait);
+
+
+STATIC mp_obj_t rm67162_RM67162_busy(mp_obj_t self_in)
+{
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (self->lcd_panel_p && self->lcd_panel_p->busy(self->bus_obj)) {
+        return mp_const_true;
+    }
+    self->tx_obj = MP_OBJ_NULL;
+    return mp_const_false;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_busy_obj, rm67162_RM67162_busy);
+
+
 STATIC mp_obj_t rm67162_RM67162_deinit(mp_obj_t self_in)
 {
     rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
@@ -266,6 +597,15 @@ STATIC mp_obj_t rm67162_RM67162_deinit(mp_obj_t self_in)
     }
 
     gc_free(self->frame_buffer);
+    self->frame_buffer = NULL;
+    gc_free(self->shadow_buffer);
+    self->shadow_buffer = NULL;
+    gc_free(self->front_buffer);
+    self->front_buffer = NULL;
+    heap_caps_free(self->scratch);
+    self->scratch = NULL;
+    self->scratch_size = 0;
+    glyph_cache_free(self);
 
     //m_del_obj(rm67162_RM67162_obj_t, self); 
     return mp_const_none;
@@ -273,10 +613,25 @@ STATIC mp_obj_t rm67162_RM67162_deinit(mp_obj_t self_in)
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_deinit_obj, rm67162_RM67162_deinit);
 
 
+// Finaliser. Only the scratch arena lives outside the gc heap, the bus has a
+// finaliser of its own.
+STATIC mp_obj_t rm67162_RM67162_del(mp_obj_t self_in)
+{
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    heap_caps_free(self->scratch);
+    self->scratch = NULL;
+    self->scratch_size = 0;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_del_obj, rm67162_RM67162_del);
+
+
 STATIC mp_obj_t rm67162_RM67162_reset(mp_obj_t self_in)
 {
     rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
+    invalidate_registers(self);
     if (self->reset != MP_OBJ_NULL) {
         mp_hal_pin_obj_t reset_pin = mp_hal_get_pin_obj(self->reset);
         mp_hal_pin_write(reset_pin, self->reset_level);
@@ -303,9 +658,8 @@ STATIC mp_obj_t rm67162_RM67162_init(mp_obj_t self_in)
         self->madctl_val,
     }, 1);
 
-    write_spi(self, LCD_CMD_MADCTL, (uint8_t[]) {
-        self->madctl_val,
-    }, 1);
+    invalidate_registers(self);
+    write_madctl(self);
 
     write_spi(self, LCD_CMD_COLMOD, (uint8_t[]) {
         self->colmod_cal,
@@ -331,6 +685,7 @@ STATIC mp_obj_t rm67162_RM67162_send_cmd(size_t n_args, const mp_obj_t *args_in)
     } else {
         write_spi(self, cmd, (uint8_t[]){c_bits}, len);
     }
+    invalidate_registers(self);
 
     return mp_const_none;
 }
@@ -357,982 +712,3218 @@ STATIC mp_obj_t rm67162_RM67162_colorRGB(size_t n_args, const mp_obj_t *args_in)
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_colorRGB_obj, 4, 4, rm67162_RM67162_colorRGB);
 
 
-STATIC void set_area(rm67162_RM67162_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+/*
+CASET/RASET are only sent when they differ from the shadowed window. The row
+range is always opened to the bottom of the screen, the amount of data
+written decides where it ends. So an area with the same columns that starts
+right below the last written row is continued with RAMWRC and no address
+command at all, e.g. bitmap() called in bands.
+Returns false if the area is not on the screen, nothing must be written then.
+*/
+STATIC bool set_area(rm67162_RM67162_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
     if (x0 > x1 || x1 > self->max_width_value) {
-        return;
+        return false;
     }
     if (y0 > y1 || y1 > self->max_height_value) {
-        return;
+        return false;
     }
 
-    uint8_t bufx[4] = {
-        ((x0 >> 8) & 0xFF),
-        (x0 & 0xFF),
-        ((x1 >> 8) & 0xFF),
-        (x1 & 0xFF)};
-    uint8_t bufy[4] = {
-        ((y0 >> 8) & 0xFF),
-        (y0 & 0xFF),
-        ((y1 >> 8) & 0xFF),
-        (y1 & 0xFF)};
-    write_spi(self, LCD_CMD_CASET, bufx, 4);
-    write_spi(self, LCD_CMD_RASET, bufy, 4);
-}
-
-// this function is extremely dangerous and should be called with a lot of care.
-STATIC void fill_color_buffer_fast(rm67162_RM67162_obj_t *self, uint32_t color, int len /*in pixel*/) {
-    if (len > self->frame_buffer_size / 2) {
-        mp_raise_ValueError(MP_ERROR_TEXT("fill_color_buffer: maximum length exceeded, please check dimensions."));
-        return;
+    if (self->window_valid && x0 == self->window[0] && x1 == self->window[2]) {
+        uint16_t w = x1 - x0 + 1;
+        if (self->window_pos % w == 0 && y0 == self->window[1] + self->window_pos / w) {
+            if (self->window_pos) {
+                self->ramwr_cmd = LCD_CMD_RAMWRC;
+            }
+            return true;
+        }
+    }
+
+    y1 = self->max_height_value;
+    if (!self->window_valid || x0 != self->window[0] || x1 != self->window[2]) {
+        uint8_t bufx[4] = {
+            ((x0 >> 8) & 0xFF),
+            (x0 & 0xFF),
+            ((x1 >> 8) & 0xFF),
+            (x1 & 0xFF)};
+        write_spi(self, LCD_CMD_CASET, bufx, 4);
     }
-    uint32_t *buffer = (uint32_t *)self->frame_buffer;
-    color = (color << 16) | color;
-    // this ensures that the framebuffer is overfilled rather than unfilled.
-    // also because the framebuffer_size is always even, you should not worry
-    // about exceeding it.
-    size_t size = (len + 1) / 2; 
-    while (size--) {
-        *buffer++ = color;
+    if (!self->window_valid || y0 != self->window[1] || y1 != self->window[3]) {
+        uint8_t bufy[4] = {
+            ((y0 >> 8) & 0xFF),
+            (y0 & 0xFF),
+            ((y1 >> 8) & 0xFF),
+            (y1 & 0xFF)};
+        write_spi(self, LCD_CMD_RASET, bufy, 4);
     }
-    write_color(self, self->frame_buffer, len * 2);
+    self->window[0] = x0;
+    self->window[1] = y0;
+    self->window[2] = x1;
+    self->window[3] = y1;
+    self->window_valid = true;
+    self->window_pos = 0;
+    self->ramwr_cmd = LCD_CMD_RAMWR;
+    return true;
 }
 
-// Slower but does not require a frame buffer.
-STATIC void fill_color_buffer_slow(rm67162_RM67162_obj_t *self, uint16_t color, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-    size_t area_pixel_size = w * h;
-    
-    if (area_pixel_size <= MAX_BUFFER_SIZE_IN_PIXEL) {
-        self->frame_buffer = m_malloc(MAX_BUFFER_SIZE_IN_PIXEL * 2);
-        for (int i = 0; i < MAX_BUFFER_SIZE_IN_PIXEL; i++) {
-            self->frame_buffer[i] = color;
-        }
-        // Everything is in the buffer, so just write it to the area.
-        set_area(self, x, y, x + w - 1, y + h - 1);
-        write_color(self, (uint8_t *)self->frame_buffer, MAX_BUFFER_SIZE_IN_PIXEL * 2);
-    } else { // In this case, maybe MAX_BUFFER_SIZE_IN_PIXEL divides the area width, but most likely not.
-        // So we fix the width, and define chunk_height being: chunk_height * width <= MAX_BUFFER_SIZE_IN_PIXEL
-        // and (chunk_height + 1) * width > MAX_BUFFER_SIZE_IN_PIXEL. 
-        // Our new buffer_pixel_size = chunk_height * width.
-        // And the chunks will be area_pixel_size / buffer_pixel_size.
-        // And the rest will be area_pixel_size % buffer_pixel_size. And since w divides both 
-        // area_pixel_size and buffer_pixel_size, the rest_height will be rest / w.
-        uint16_t chunk_height = MAX_BUFFER_SIZE_IN_PIXEL / w;
-        size_t buffer_pixel_size = chunk_height * w;
-        int chunks = area_pixel_size / buffer_pixel_size;
-        int rest = area_pixel_size % buffer_pixel_size;
-
-        self->frame_buffer = m_malloc(buffer_pixel_size * 2);
-        for (int i = 0; i < buffer_pixel_size; i++) {
-            self->frame_buffer[i] = color;
-        }
-
-        for (int j = 0; j < chunks; j++) {
-            set_area(self, x, y + (chunk_height * j), x + w - 1, y + (chunk_height * (j + 1)) - 1);
-            write_color(self, (uint8_t *)self->frame_buffer, buffer_pixel_size * 2);
-        }
-
-        if (rest) {
-            uint16_t rest_height = rest / w;
-            set_area(self, x, y + h - rest_height, x + w - 1, y + h - 1);
-            write_color(self, (uint8_t *)self->frame_buffer, rest * 2);
-        }
-    }        
-    
-    m_free(self->frame_buffer);
+/*
+Presentation. With tearing() enabled a flush starts right after the panel
+signals the start of a frame, on the TE pin or, without one, when the
+scanline read with GDCAN wraps around. frame_rate() paces show() to a fixed
+period and counts the frames that started late.
+*/
+
+STATIC uint16_t read_scanline(rm67162_RM67162_obj_t *self) {
+    uint8_t buf[2];
+    read_spi(self, LCD_CMD_GDCAN, buf, 2);
+    return (buf[0] << 8) | buf[1];
 }
 
 
-STATIC void fill_color_buffer(rm67162_RM67162_obj_t *self, uint16_t color, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-    if (self->use_frame_buffer && self->frame_buffer == NULL) {
-        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No framebuffer available."));
+// Waits for the rising edge of TE, gives up after RM67162_TE_TIMEOUT_US.
+STATIC void wait_te(rm67162_RM67162_obj_t *self) {
+    if (!self->te_enabled) {
+        return;
     }
-    if (self->use_frame_buffer && self->frame_buffer) {
-        set_area(self, x, y, x + w - 1, y + h - 1);
-        fill_color_buffer_fast(self, color, w * h);
+    wait_color(self);
+
+    mp_uint_t start = mp_hal_ticks_us();
+    if (self->te_pin != MP_OBJ_NULL) {
+        mp_hal_pin_obj_t te_pin = mp_hal_get_pin_obj(self->te_pin);
+        while (mp_hal_pin_read(te_pin)) {
+            if (mp_hal_ticks_us() - start > RM67162_TE_TIMEOUT_US) {
+                return;
+            }
+            mp_hal_delay_us(RM67162_TE_POLL_US);
+        }
+        while (!mp_hal_pin_read(te_pin)) {
+            if (mp_hal_ticks_us() - start > RM67162_TE_TIMEOUT_US) {
+                return;
+            }
+            mp_hal_delay_us(RM67162_TE_POLL_US);
+        }
     } else {
-        fill_color_buffer_slow(self, color, x, y, w, h);
+        uint16_t prev = read_scanline(self);
+        while (mp_hal_ticks_us() - start <= RM67162_TE_TIMEOUT_US) {
+            mp_hal_delay_us(RM67162_TE_POLL_US);
+            uint16_t line = read_scanline(self);
+            if (line < prev) {
+                return;
+            }
+            prev = line;
+        }
     }
 }
 
 
-STATIC void draw_pixel(rm67162_RM67162_obj_t *self, uint16_t x, uint16_t y, uint16_t color) {
-    set_area(self, x, y, x, y);
-    write_color(self, (uint8_t *) &color, 2);
+// Sleeps until the next frame is due. A frame that is due already counts as
+// missed, and if it is more than a period late the schedule starts over.
+STATIC void pace_frame(rm67162_RM67162_obj_t *self) {
+    if (self->frame_period_us == 0) {
+        return;
+    }
+    self->frame_deadline += self->frame_period_us;
+    int32_t ahead = (int32_t)(self->frame_deadline - mp_hal_ticks_us());
+    if (ahead > 0) {
+        mp_hal_delay_us(ahead);
+    } else {
+        self->stat_missed++;
+        if (-ahead > (int32_t)self->frame_period_us) {
+            self->frame_deadline = mp_hal_ticks_us();
+        }
+    }
 }
 
 
-STATIC mp_obj_t rm67162_RM67162_pixel(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    uint16_t x = mp_obj_get_int(args_in[1]);
-    uint16_t y = mp_obj_get_int(args_in[2]);
-    uint16_t color = mp_obj_get_int(args_in[3]);
-
-    draw_pixel(self, x, y, color);
+/*
+Retained mode. With use_frame_buffer every primitive draws into frame_buffer,
+which is laid out with the current width, and show() sends it in one stream.
+*/
 
-    return mp_const_none;
+// A running show() still reads the frame buffer, unless it is double buffered.
+STATIC uint16_t *fb_acquire(rm67162_RM67162_obj_t *self) {
+    if (self->frame_buffer == NULL) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No framebuffer available."));
+    }
+    if (self->front_buffer == NULL) {
+        wait_color(self);
+    }
+    return self->frame_buffer;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_pixel_obj, 4, 4, rm67162_RM67162_pixel);
 
 
-STATIC mp_obj_t rm67162_RM67162_fill(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    uint16_t color = mp_obj_get_int(args_in[1]);
+/*
+Dirty tracking. Writes into the frame buffer set the bits of the 16x16 tiles
+they touch, show() merges the tiles into at most RM67162_MAX_DIRTY rectangles
+and sends only those.
+*/
 
-    fill_color_buffer(self, color, 0, 0, self->width, self->height);
-    
-    return mp_const_none;
+STATIC void dirty_mark_all(rm67162_RM67162_obj_t *self) {
+    for (int ty = 0; ty < self->tiles_y; ty++) {
+        for (int tx = 0; tx < self->tiles_x; tx++) {
+            int i = ty * self->tiles_x + tx;
+            self->dirty_tiles[i >> 5] |= 1u << (i & 31);
+        }
+    }
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_obj, 2, 2, rm67162_RM67162_fill);
 
 
-STATIC void fast_hline(rm67162_RM67162_obj_t *self, int x, int y, uint16_t l, uint16_t color) {
-    if (y < 0) {
-        return;
+STATIC void dirty_clear(rm67162_RM67162_obj_t *self) {
+    memset(self->dirty_tiles, 0, ((self->tiles_x * self->tiles_y + 31) / 32) * 4);
+}
+
+
+// Marks the pixel x0..x1, y0..y1, which must be on the screen.
+STATIC void dirty_mark(rm67162_RM67162_obj_t *self, int x0, int y0, int x1, int y1) {
+    int tx1 = x1 >> RM67162_TILE_SHIFT;
+    int ty1 = y1 >> RM67162_TILE_SHIFT;
+    for (int ty = y0 >> RM67162_TILE_SHIFT; ty <= ty1; ty++) {
+        for (int tx = x0 >> RM67162_TILE_SHIFT; tx <= tx1; tx++) {
+            int i = ty * self->tiles_x + tx;
+            self->dirty_tiles[i >> 5] |= 1u << (i & 31);
+        }
     }
-    if (l == 0) {
-        return;
+}
+
+
+STATIC bool dirty_test(rm67162_RM67162_obj_t *self, int tx, int ty) {
+    int i = ty * self->tiles_x + tx;
+    return (self->dirty_tiles[i >> 5] >> (i & 31)) & 1;
+}
+
+
+// Merges the dirty tiles into rectangles in pixel. Runs of tiles in a tile row
+// extend a rectangle of the row above with the same columns. When all slots are
+// used a run is added to the rectangle that grows the least.
+STATIC int dirty_rects(rm67162_RM67162_obj_t *self, rm67162_rect_t *rects) {
+    int n = 0;
+    for (int ty = 0; ty < self->tiles_y; ty++) {
+        int tx = 0;
+        while (tx < self->tiles_x) {
+            if (!dirty_test(self, tx, ty)) {
+                tx++;
+                continue;
+            }
+            int tx0 = tx;
+            while (tx < self->tiles_x && dirty_test(self, tx, ty)) {
+                tx++;
+            }
+
+            // rectangles in tile units until the end
+            int i;
+            for (i = 0; i < n; i++) {
+                if (rects[i].x == tx0 && rects[i].w == tx - tx0 && rects[i].y + rects[i].h == ty) {
+                    rects[i].h++;
+                    break;
+                }
+            }
+            if (i < n) {
+                continue;
+            }
+            if (n < RM67162_MAX_DIRTY) {
+                rects[n++] = (rm67162_rect_t) { tx0, ty, tx - tx0, 1 };
+                continue;
+            }
+
+            int best = 0;
+            int best_growth = INT32_MAX;
+            for (i = 0; i < n; i++) {
+                int x0 = MIN(rects[i].x, tx0);
+                int x1 = MAX(rects[i].x + rects[i].w, tx);
+                int y0 = rects[i].y;
+                int growth = (x1 - x0) * (ty + 1 - y0) - rects[i].w * rects[i].h;
+                if (growth < best_growth) {
+                    best = i;
+                    best_growth = growth;
+                }
+            }
+            int x0 = MIN(rects[best].x, tx0);
+            int x1 = MAX(rects[best].x + rects[best].w, tx);
+            rects[best].x = x0;
+            rects[best].w = x1 - x0;
+            rects[best].h = ty + 1 - rects[best].y;
+        }
     }
 
-    if (l == 1) {
-        draw_pixel(self, x, y, color);
-    } else {
-        if (x < 0) {
-            l += x;
-            x = 0;
+    for (int i = 0; i < n; i++) {
+        rects[i].x <<= RM67162_TILE_SHIFT;
+        rects[i].y <<= RM67162_TILE_SHIFT;
+        rects[i].w <<= RM67162_TILE_SHIFT;
+        rects[i].h <<= RM67162_TILE_SHIFT;
+        if (rects[i].x + rects[i].w > self->width) {
+            rects[i].w = self->width - rects[i].x;
         }
-        if (x > self->max_width_value) {
-            x = self->max_width_value; // This is to prevent overflow that could occur at *1
+        if (rects[i].y + rects[i].h > self->height) {
+            rects[i].h = self->height - rects[i].y;
         }
-        if (x + l > self->max_width_value) {
-            l = self->max_width_value - x; // *1
-        } 
-        fill_color_buffer(self, color, x, y, l, 1);
     }
+    return n;
 }
 
 
-STATIC void fast_vline(rm67162_RM67162_obj_t *self, int x, int y, uint16_t l, uint16_t color) {
-    if (x < 0) {
+// Sends one rectangle of the frame buffer. Full rows are contiguous and go out
+// in the background, narrower ones are gathered into flush_buf first.
+STATIC void fb_flush_rect(rm67162_RM67162_obj_t *self, const rm67162_rect_t *r) {
+    if (!set_area(self, r->x, r->y, r->x + r->w - 1, r->y + r->h - 1)) {
         return;
     }
-    if (l == 0) {
+    const uint16_t *src = self->frame_buffer + r->y * self->width + r->x;
+    if (r->w == self->width) {
+        write_color_async(self, src, r->w * r->h * 2);
         return;
     }
 
-    if (l == 1) {
-        draw_pixel(self, x, y, color);
-    } else {
-        if (y < 0) {
-            l += y;
-            y = 0;
+    int rows = (RM67162_FLUSH_BUF_SIZE / 2) / r->w;
+    for (int y = 0; y < r->h; y += rows) {
+        int n = MIN(rows, r->h - y);
+        uint16_t *dst = self->flush_buf;
+        for (int i = 0; i < n; i++) {
+            memcpy(dst, src, r->w * 2);
+            dst += r->w;
+            src += self->width;
         }
-        if (y > self->max_width_value) {
-            y = self->max_width_value; // This is to prevent overflow that could occur at *2
+        write_color(self, self->flush_buf, n * r->w * 2);
+    }
+}
+
+
+/*
+Frame diffing. With frame_diff the last sent frame is kept in shadow_buffer
+and show() compares the whole frame buffer against it, so writes the dirty
+tiles do not see (e.g. through frame_buffer()) are found as well. Consecutive
+changed rows are sent as one band over the union of their changed columns.
+*/
+
+// Finds the first and the last differing pixel of n. Two pixel are compared
+// at a time when the rows are word aligned. Returns false if they are equal.
+STATIC bool diff_row(const uint16_t *a, const uint16_t *b, int n, int *first, int *last) {
+    int i = 0;
+    int j = n - 1;
+
+    if (((uintptr_t)a & 3) == 0 && ((uintptr_t)b & 3) == 0) {
+        const uint32_t *wa = (const uint32_t *)a;
+        const uint32_t *wb = (const uint32_t *)b;
+        int words = n / 2;
+        int k = 0;
+        while (k < words && wa[k] == wb[k]) {
+            k++;
         }
-        if (y + l > self->max_height_value) {
-            l = self->max_height_value - y; // *2
+        i = k * 2;
+        if (k < words) {
+            k = words - 1;
+            while (wa[k] == wb[k]) {
+                k--;
+            }
+            j = k * 2 + 1;
+            if ((n & 1) && a[n - 1] != b[n - 1]) {
+                j = n - 1;
+            }
         }
-        fill_color_buffer(self, color, x, y, 1, l + 1);
     }
+    while (i < n && a[i] == b[i]) {
+        i++;
+    }
+    if (i == n) {
+        return false;
+    }
+    while (a[j] == b[j]) {
+        j--;
+    }
+    *first = i;
+    *last = j;
+    return true;
 }
 
-STATIC mp_obj_t rm67162_RM67162_hline(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    int x = mp_obj_get_int(args_in[1]);
-    int y = mp_obj_get_int(args_in[2]);
-    uint16_t l = mp_obj_get_int(args_in[3]);
-    uint16_t color = mp_obj_get_int(args_in[4]);
 
-    fast_hline(self, x, y, l, color);
-    return mp_const_none;
+STATIC void show_diff_band(rm67162_RM67162_obj_t *self, int x0, int y0, int x1, int y1) {
+    rm67162_rect_t r = { x0, y0, x1 - x0 + 1, y1 - y0 + 1 };
+    fb_flush_rect(self, &r);
+    for (int y = y0; y <= y1; y++) {
+        size_t offset = y * self->width + x0;
+        memcpy(self->shadow_buffer + offset, self->frame_buffer + offset, r.w * 2);
+    }
+    self->stat_dirty_bytes += r.w * r.h * 2;
+    self->stat_rects++;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_hline_obj, 5, 5, rm67162_RM67162_hline);
 
 
-STATIC mp_obj_t rm67162_RM67162_vline(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    int x = mp_obj_get_int(args_in[1]);
-    int y = mp_obj_get_int(args_in[2]);
-    uint16_t l = mp_obj_get_int(args_in[3]);
-    uint16_t color = mp_obj_get_int(args_in[4]);
+STATIC void show_diff(rm67162_RM67162_obj_t *self) {
+    int band_y = -1;
+    int band_x0 = 0;
+    int band_x1 = 0;
+    size_t sent = self->stat_dirty_bytes;
+
+    for (int y = 0; y < self->height; y++) {
+        size_t offset = y * self->width;
+        int first, last;
+        if (diff_row(self->frame_buffer + offset, self->shadow_buffer + offset, self->width, &first, &last)) {
+            if (band_y < 0) {
+                band_y = y;
+                band_x0 = first;
+                band_x1 = last;
+            } else {
+                band_x0 = MIN(band_x0, first);
+                band_x1 = MAX(band_x1, last);
+            }
+        } else if (band_y >= 0) {
+            show_diff_band(self, band_x0, band_y, band_x1, y - 1);
+            band_y = -1;
+        }
+    }
+    if (band_y >= 0) {
+        show_diff_band(self, band_x0, band_y, band_x1, self->height - 1);
+    }
 
-    fast_vline(self, x, y, l, color);
-    return mp_const_none;
+    self->stat_skipped_bytes += self->width * self->height * 2 - (self->stat_dirty_bytes - sent);
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_vline_obj, 5, 5, rm67162_RM67162_vline);
 
 
+STATIC void fb_fill(rm67162_RM67162_obj_t *self, int x, int y, int w, int h, uint16_t color) {
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (x + w > self->width) {
+        w = self->width - x;
+    }
+    if (y + h > self->height) {
+        h = self->height - y;
+    }
+    if (w <= 0 || h <= 0) {
+        return;
+    }
 
-STATIC void rect(rm67162_RM67162_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t l, uint16_t color) {
-    fast_hline(self, x, y, w - 1, color);
-    fast_hline(self, x, y + l - 1, w - 1, color);
-    fast_vline(self, x, y, l - 1, color);
-    fast_vline(self, x + w - 1, y, l - 1, color);
+    dirty_mark(self, x, y, x + w - 1, y + h - 1);
+    uint16_t *row = fb_acquire(self) + y * self->width + x;
+    while (h--) {
+        for (int i = 0; i < w; i++) {
+            row[i] = color;
+        }
+        row += self->width;
+    }
 }
 
 
-STATIC mp_obj_t rm67162_RM67162_rect(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    uint16_t x = mp_obj_get_int(args_in[1]);
-    uint16_t y = mp_obj_get_int(args_in[2]);
-    uint16_t w = mp_obj_get_int(args_in[3]);
-    uint16_t l = mp_obj_get_int(args_in[4]);
-    uint16_t color = mp_obj_get_int(args_in[5]);
+// Copies len pixel into the window (x0, y0) - (x1, y1) row by row, the same
+// way the panel fills its ram after set_area().
+STATIC void fb_write(rm67162_RM67162_obj_t *self, int x0, int y0, int x1, int y1, const uint16_t *buf, size_t len) {
+    int w = x1 - x0 + 1;
+    if (w <= 0 || y1 < y0 || len == 0) {
+        return;
+    }
+    int dx0 = MAX(x0, 0);
+    int dy0 = MAX(y0, 0);
+    int dx1 = MIN(x1, self->width - 1);
+    int dy1 = MIN(MIN(y1, y0 + (int)((len - 1) / w)), self->height - 1);
+    if (dx0 > dx1 || dy0 > dy1) {
+        return;
+    }
+    dirty_mark(self, dx0, dy0, dx1, dy1);
+
+    uint16_t *fb = fb_acquire(self);
+    for (int y = y0; y <= y1 && len > 0; y++) {
+        size_t n = ((size_t)w < len) ? (size_t)w : len;
+        if (y >= 0 && y < self->height) {
+            for (int i = 0; i < n; i++) {
+                int x = x0 + i;
+                if (x >= 0 && x < self->width) {
+                    fb[y * self->width + x] = buf[i];
+                }
+            }
+        }
+        buf += n;
+        len -= n;
+    }
+}
 
-    rect(self, x, y, w, l, color);
-    return mp_const_none;
+
+// Sends a w * h pixel buffer to the panel, or copies it into the frame buffer.
+STATIC void blit_buffer(rm67162_RM67162_obj_t *self, int x, int y, int w, int h, const uint16_t *buf) {
+    if (self->use_frame_buffer) {
+        fb_write(self, x, y, x + w - 1, y + h - 1, buf, w * h);
+    } else if (set_area(self, x, y, x + w - 1, y + h - 1)) {
+        write_color(self, (const uint8_t *)buf, w * h * 2);
+    }
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_rect_obj, 6, 6, rm67162_RM67162_rect);
 
 
-STATIC void fill_rect(rm67162_RM67162_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-    // set_area(self, x, y, x + w - 1, y + h - 1);
-    fill_color_buffer(self, color, x, y, w, h);
+/*
+Region batching. Between batch_begin() and batch_end() draw_pixel() and small
+fills are collected and sent with one tx_regions() call per RM67162_BATCH_SIZE
+regions instead of set_area() + write_color() each.
+*/
+
+STATIC void batch_flush(rm67162_RM67162_obj_t *self) {
+    if (self->batch_len == 0) {
+        return;
+    }
+    if (self->lcd_panel_p) {
+        self->lcd_panel_p->tx_regions(self->bus_obj, self->batch, self->batch_len);
+    } else {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to find the panel object."));
+    }
+
+    // the panel is left with the window of the last region
+    rm67162_region_t *last = &self->batch[self->batch_len - 1];
+    self->window[0] = last->x0;
+    self->window[1] = last->y0;
+    self->window[2] = last->x1;
+    self->window[3] = last->y1;
+    self->window_valid = true;
+    self->window_pos = last->color_size / (self->fb_bpp / 8);
+    self->ramwr_cmd = LCD_CMD_RAMWRC;
+    self->batch_len = 0;
 }
 
 
-STATIC mp_obj_t rm67162_RM67162_fill_rect(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    uint16_t x = mp_obj_get_int(args_in[1]);
-    uint16_t y = mp_obj_get_int(args_in[2]);
-    uint16_t w = mp_obj_get_int(args_in[3]);
-    uint16_t l = mp_obj_get_int(args_in[4]);
-    uint16_t color = mp_obj_get_int(args_in[5]);
+STATIC void batch_begin(rm67162_RM67162_obj_t *self) {
+    self->batch_depth++;
+}
 
-    fill_rect(self, x, y, w, l, color);
-    return mp_const_none;
+
+STATIC void batch_end(rm67162_RM67162_obj_t *self) {
+    if (self->batch_depth && --self->batch_depth == 0) {
+        batch_flush(self);
+    }
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_rect_obj, 6, 6, rm67162_RM67162_fill_rect);
 
-STATIC void fill_bubble_rect(rm67162_RM67162_obj_t *self, int xs, int ys, int w, int h, uint16_t color) {
-    if (xs + w > self->width || ys + h > self->height) {
-        return;
+
+// Like set_area() the rows are opened to the bottom, and address commands
+// equal to the preceding region or the shadowed window are left out.
+STATIC void batch_add(rm67162_RM67162_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, const void *color, size_t len) {
+    if (self->batch_len == RM67162_BATCH_SIZE) {
+        batch_flush(self);
     }
-    int bubble_size;
-    if (w < h) {
-        bubble_size = w / 4;
-    } else {
-        bubble_size = h / 4;
+    uint16_t y1 = self->max_height_value;
+    const uint16_t *prev = NULL;
+    uint16_t prev_window[4];
+    if (self->batch_len) {
+        rm67162_region_t *last = &self->batch[self->batch_len - 1];
+        prev_window[0] = last->x0;
+        prev_window[1] = last->y0;
+        prev_window[2] = last->x1;
+        prev_window[3] = last->y1;
+        prev = prev_window;
+    } else if (self->window_valid) {
+        prev = self->window;
     }
-    
-    int xm = xs + bubble_size;
-    int ym = ys + bubble_size;
-    int x = 0;
-    int y = bubble_size;
-    int p = 1 - bubble_size;
-    
-    if ((w < (bubble_size * 2)) | (h < (bubble_size * 2))){
+
+    rm67162_region_t *region = &self->batch[self->batch_len++];
+    region->x0 = x0;
+    region->y0 = y0;
+    region->x1 = x1;
+    region->y1 = y1;
+    region->flags = 0;
+    if (prev && x0 == prev[0] && x1 == prev[2]) {
+        region->flags |= QSPI_REGION_KEEP_CASET;
+    }
+    if (prev && y0 == prev[1] && y1 == prev[3]) {
+        region->flags |= QSPI_REGION_KEEP_RASET;
+    }
+    region->color = color;
+    region->color_size = len;
+}
+
+
+STATIC void batch_pixel(rm67162_RM67162_obj_t *self, uint16_t x, uint16_t y, uint16_t color) {
+    if (x > self->max_width_value || y > self->max_height_value) {
         return;
-    } else {
-        fill_rect(self, xs, ys + bubble_size - 1, w, h - bubble_size * 2, color);
     }
+    if (self->batch_len == RM67162_BATCH_SIZE) {
+        batch_flush(self);
+    }
+    self->batch_pixel[self->batch_len] = color;
+    batch_add(self, x, y, x, &self->batch_pixel[self->batch_len], 2);
+}
 
-    while (x <= y) {
-        // top left to right
-        fast_hline(self, xm - x, ym - y, w - bubble_size * 2 + x * 2 - 1, color);
-        fast_hline(self, xm - y, ym - x, w - bubble_size * 2 + y * 2 - 1, color);
-        
-        // bottom left to right
-        fast_hline(self, xm - x, ym + h - bubble_size * 2 + y - 1, w - bubble_size * 2 + x * 2 - 1, color);
-        fast_hline(self, xm - y, ym + h - bubble_size * 2 + x - 1, w - bubble_size * 2 + y * 2 - 1, color);
-        
-        if (p < 0) {
-            p += 2 * x + 3;
-        } else {
-            p += 2 * (x - y) + 5;
-            y -= 1;
-        } 
-        x += 1;
+
+// w * h must not exceed batch_line_len.
+STATIC void batch_fill(rm67162_RM67162_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    uint16_t x1 = x + w - 1;
+    uint16_t y1 = y + h - 1;
+    if (w == 0 || h == 0 || x > x1 || x1 > self->max_width_value || y > y1 || y1 > self->max_height_value) {
+        return;
     }
+    size_t len = w * h;
+    if (color != self->batch_line_color) {
+        batch_flush(self); // pending regions may still point at the old color
+        self->batch_line_color = color;
+        self->batch_line_fill = 0;
+    }
+    while (self->batch_line_fill < len) {
+        self->batch_line[self->batch_line_fill++] = color;
+    }
+    batch_add(self, x, y, x1, self->batch_line, len * 2);
 }
 
 
-STATIC mp_obj_t rm67162_RM67162_fill_bubble_rect(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    int xs = mp_obj_get_int(args_in[1]);
-    int ys = mp_obj_get_int(args_in[2]);
-    int w = mp_obj_get_int(args_in[3]);
-    int h = mp_obj_get_int(args_in[4]);
-    uint16_t color = mp_obj_get_int(args_in[5]);
+// Does not require a frame buffer. A block of RM67162_FILL_BLOCK pixel is
+// filled with the color and repeated over the whole area.
+STATIC void fill_color_buffer_slow(rm67162_RM67162_obj_t *self, uint16_t color, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    size_t area_pixel_size = w * h;
 
-    fill_bubble_rect(self, xs, ys, w, h, color);
-    return mp_const_none;
+    if (!set_area(self, x, y, x + w - 1, y + h - 1)) {
+        return;
+    }
+
+    size_t buf_size = MIN(area_pixel_size, RM67162_FILL_BLOCK) * 2;
+    uint16_t *buffer = scratch_get(self, buf_size, &buf_size);
+    for (int i = 0; i < buf_size / 2; i++) {
+        buffer[i] = color;
+    }
+    write_color_repeat(self, buffer, buf_size, area_pixel_size * 2);
+
+    scratch_put(self, buffer);
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_bubble_rect_obj, 6, 6, rm67162_RM67162_fill_bubble_rect);
 
-STATIC void bubble_rect(rm67162_RM67162_obj_t *self, int xs, int ys, int w, int h, uint16_t color) {
-    if (xs + w > self->width || ys + h > self->height) {
+
+STATIC void fill_color_buffer(rm67162_RM67162_obj_t *self, uint16_t color, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    if (self->use_frame_buffer) {
+        fb_fill(self, x, y, w, h, color);
         return;
     }
-    int bubble_size;
-    if (w < h) {
-        bubble_size = w / 4;
-    } else {
-        bubble_size = h / 4;
+    if (self->batch_depth) {
+        if (w * h <= self->batch_line_len) {
+            batch_fill(self, x, y, w, h, color);
+            return;
+        }
+        batch_flush(self);
     }
-    
-    int xm = xs + bubble_size;
-    int ym = ys + bubble_size;
-    int x = 0;
-    int y = bubble_size;
-    int p = 1 - bubble_size;
-    
-    if ((w < (bubble_size * 2)) | (h < (bubble_size * 2))){
+    fill_color_buffer_slow(self, color, x, y, w, h);
+}
+
+
+STATIC void draw_pixel(rm67162_RM67162_obj_t *self, uint16_t x, uint16_t y, uint16_t color) {
+    if (self->use_frame_buffer) {
+        fb_fill(self, x, y, 1, 1, color);
         return;
-    } else {
-        fast_hline(self, xs + bubble_size - 1, ys, w - bubble_size * 2, color);
-        fast_hline(self, xs + bubble_size - 1, ys + h - 1, w - bubble_size * 2, color);
-        fast_vline(self, xs, ys + bubble_size - 1, h - bubble_size * 2, color);
-        fast_vline(self, xs + w -1, ys + bubble_size - 1, h - bubble_size * 2, color);
     }
-
-    while (x <= y){
-        // top left
-        draw_pixel(self, xm - x, ym - y, color);
-        draw_pixel(self, xm - y, ym - x, color);
-        
-        // top right
-        draw_pixel(self, xm + w - bubble_size * 2 + x - 1, ym - y, color);
-        draw_pixel(self, xm + w - bubble_size * 2 + y - 1, ym - x, color);
-        
-        // bottom left
-        draw_pixel(self, xm - x, ym + h - bubble_size * 2 + y - 1, color);
-        draw_pixel(self, xm - y, ym + h - bubble_size * 2 + x - 1, color);
-        
-        // bottom right
-        draw_pixel(self, xm + w - bubble_size * 2 + x - 1, ym + h - bubble_size * 2 + y - 1, color);
-        draw_pixel(self, xm + w - bubble_size * 2 + y - 1, ym + h - bubble_size * 2 + x - 1, color);
-        
-        if (p < 0) {
-            p += 2 * x + 3;
-        } else {
-            p += 2 * (x - y) + 5;
-            y -= 1;
-        }
-        x += 1;
+    if (self->batch_depth) {
+        batch_pixel(self, x, y, color);
+        return;
+    }
+    if (set_area(self, x, y, x, y)) {
+        write_color(self, (uint8_t *) &color, 2);
     }
 }
 
 
-STATIC mp_obj_t rm67162_RM67162_bubble_rect(size_t n_args, const mp_obj_t *args_in) {
+STATIC mp_obj_t rm67162_RM67162_pixel(size_t n_args, const mp_obj_t *args_in) {
     rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    int xs = mp_obj_get_int(args_in[1]);
-    int ys = mp_obj_get_int(args_in[2]);
-    int w = mp_obj_get_int(args_in[3]);
-    int h = mp_obj_get_int(args_in[4]);
-    uint16_t color = mp_obj_get_int(args_in[5]);
+    uint16_t x = mp_obj_get_int(args_in[1]);
+    uint16_t y = mp_obj_get_int(args_in[2]);
+    uint16_t color = mp_obj_get_int(args_in[3]);
+
+    draw_pixel(self, x, y, color);
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_pixel_obj, 4, 4, rm67162_RM67162_pixel);
+
+
+STATIC mp_obj_t rm67162_RM67162_fill(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    uint16_t color = mp_obj_get_int(args_in[1]);
 
-    bubble_rect(self, xs, ys, w, h, color);
+    fill_color_buffer(self, color, 0, 0, self->width, self->height);
+    
     return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_bubble_rect_obj, 6, 6, rm67162_RM67162_bubble_rect);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_obj, 2, 2, rm67162_RM67162_fill);
 
 
 /*
-Similar to: https://en.wikipedia.org/wiki/Midpoint_circle_algorithm
+Span rasterization. Shapes collect up to two runs per row, one left and one
+right of split, and spans_end() sends them as bands: consecutive rows with
+the same run become one rectangle, in the frame buffer or as one region.
 */
-STATIC void circle(rm67162_RM67162_obj_t *self, int xm, int ym, int r, uint16_t color) {
-    int x = 0;
-    int y = r;
-    int p = 1 - r;
-
-    while (x <= y) {
-        draw_pixel(self, xm + x, ym + y, color);
-        draw_pixel(self, xm + x, ym - y, color);
-        draw_pixel(self, xm - x, ym + y, color);
-        draw_pixel(self, xm - x, ym - y, color);
-        draw_pixel(self, xm + y, ym + x, color);
-        draw_pixel(self, xm + y, ym - x, color);
-        draw_pixel(self, xm - y, ym + x, color);
-        draw_pixel(self, xm - y, ym - x, color);
 
-        if (p < 0) {
-            p += 2 * x + 3;
-        } else {
-            p += 2 * (x - y) + 5;
-            y -= 1;
-        }
-        x += 1;
+typedef struct _rm67162_spans_t {
+    int y0;             // first row
+    int rows;
+    int split;          // first column of the right run
+    int width;          // runs are clipped to 0 .. width - 1
+    int16_t *run;       // left x0, x1, right x0, x1 per row, x0 > x1 while empty
+    uint16_t color;     // for spans_band_fn()
+} rm67162_spans_t;
+
+
+// Only the rows on the display are kept, however large the shape.
+STATIC void spans_begin(rm67162_RM67162_obj_t *self, rm67162_spans_t *spans, int y0, int rows, int split) {
+    int y1 = MIN(y0 + rows, (int)self->height);
+    y0 = MAX(y0, 0);
+    rows = MAX(y1 - y0, 0);
+    size_t size = rows * 4 * sizeof(int16_t);
+    spans->y0 = y0;
+    spans->rows = rows;
+    spans->split = split;
+    spans->width = self->width;
+    spans->run = scratch_get(self, size, &size);
+    for (int i = 0; i < rows * 4; i += 2) {
+        spans->run[i] = INT16_MAX;
+        spans->run[i + 1] = INT16_MIN;
     }
 }
 
 
-STATIC mp_obj_t rm67162_RM67162_circle(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    int xm = mp_obj_get_int(args_in[1]);
-    int ym = mp_obj_get_int(args_in[2]);
-    int r = mp_obj_get_int(args_in[3]);
-    uint16_t color = mp_obj_get_int(args_in[4]);
+STATIC void spans_add(rm67162_spans_t *spans, int x0, int x1, int y) {
+    y -= spans->y0;
+    x0 = MAX(x0, 0);
+    x1 = MIN(x1, spans->width - 1);
+    if (y < 0 || y >= spans->rows || x0 > x1) {
+        return;
+    }
+    int16_t *run = spans->run + y * 4;
+    if (x0 < spans->split) {
+        run[0] = MIN(run[0], x0);
+        run[1] = MAX(run[1], MIN(x1, spans->split - 1));
+    }
+    if (x1 >= spans->split) {
+        run[2] = MIN(run[2], MAX(x0, spans->split));
+        run[3] = MAX(run[3], x1);
+    }
+}
 
-    circle(self, xm, ym, r, color);
-    return mp_const_none;
+
+STATIC void spans_band(rm67162_RM67162_obj_t *self, int x0, int x1, int y0, int y1, uint16_t color) {
+    x0 = MAX(x0, 0);
+    x1 = MIN(x1, self->max_width_value);
+    y0 = MAX(y0, 0);
+    y1 = MIN(y1, self->max_height_value);
+    if (x0 <= x1 && y0 <= y1) {
+        fill_color_buffer(self, color, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    }
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_circle_obj, 5, 5, rm67162_RM67162_circle);
 
 
-STATIC void fill_circle(rm67162_RM67162_obj_t *self, int xm, int ym, int r, uint16_t color) {
-    int x = 0;
-    int y = r;
-    int p = 1 - r;
+STATIC void spans_end(rm67162_RM67162_obj_t *self, rm67162_spans_t *spans, uint16_t color) {
+    // open band per run: x0, x1, first row
+    int band[2][3] = { { 0, -1, 0 }, { 0, -1, 0 } };
 
-    while (x <= y) {
-        fast_vline(self, xm + x, ym - y, 2 * y, color);
-        fast_vline(self, xm - x, ym - y, 2 * y, color);
-        fast_vline(self, xm + y, ym - x, 2 * x, color);
-        fast_vline(self, xm - y, ym - x, 2 * x, color);
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        scratch_put(self, spans->run);
+        nlr_jump(nlr.ret_val);
+    }
 
-        if (p < 0) {
-            p += 2 * x + 3;
-        } else {
-            p += 2 * (x - y) + 5;
-            y -= 1;
+    batch_begin(self);
+    for (int y = 0; y <= spans->rows; y++) {
+        int16_t cur[2][2] = { { 0, -1 }, { 0, -1 } };
+        if (y < spans->rows) {
+            int16_t *run = spans->run + y * 4;
+            cur[0][0] = run[0];
+            cur[0][1] = run[1];
+            cur[1][0] = run[2];
+            cur[1][1] = run[3];
+            if (cur[0][0] > cur[0][1]) {
+                cur[0][0] = cur[1][0];
+                cur[0][1] = cur[1][1];
+                cur[1][1] = cur[1][0] - 1;
+            } else if (cur[1][0] <= cur[1][1] && cur[0][1] + 1 >= cur[1][0]) {
+                cur[0][1] = cur[1][1];
+                cur[1][1] = cur[1][0] - 1;
+            }
+        }
+        for (int k = 0; k < 2; k++) {
+            if (band[k][0] == cur[k][0] && band[k][1] == cur[k][1]) {
+                continue;
+            }
+            if (band[k][0] <= band[k][1]) {
+                spans_band(self, band[k][0], band[k][1], spans->y0 + band[k][2], spans->y0 + y - 1, color);
+            }
+            band[k][0] = cur[k][0];
+            band[k][1] = cur[k][1];
+            band[k][2] = y;
         }
-        x += 1;
     }
+    batch_end(self);
+
+    nlr_pop();
+    scratch_put(self, spans->run);
 }
 
 
-STATIC mp_obj_t rm67162_RM67162_fill_circle(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    int xm = mp_obj_get_int(args_in[1]);
-    int ym = mp_obj_get_int(args_in[2]);
-    int r = mp_obj_get_int(args_in[3]);
-    uint16_t color = mp_obj_get_int(args_in[4]);
+/*
+Bounding box rendering. With a background an outline is drawn into a band
+buffer holding the background of its bounding box, as many rows at a time as
+the scratch arena allows, and every band is sent as one region. The bands
+share the window, so they continue with RAMWRC. With the frame buffer the
+bands are copied into it instead.
+*/
 
-    fill_circle(self, xm, ym, r, color);
-    return mp_const_none;
-}
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_circle_obj, 5, 5, rm67162_RM67162_fill_circle);
+typedef struct _rm67162_background_t {
+    const uint16_t *buf;    // bounding box sized, NULL for a solid color
+    uint16_t color;
+} rm67162_background_t;
 
 
-STATIC void line(rm67162_RM67162_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color) {
-    bool steep = ABS(y1 - y0) > ABS(x1 - x0);
+// Draws into band, w * rows pixel starting at (x0, y0) on the screen.
+typedef void (*rm67162_band_fn_t)(void *ctx, uint16_t *band, int x0, int y0, int w, int rows);
+
+
+// background is a color or a buffer of w * h pixel.
+STATIC void get_background(mp_obj_t background, rm67162_background_t *bg, int w, int h) {
+    if (mp_obj_is_int(background)) {
+        bg->buf = NULL;
+        bg->color = mp_obj_get_int(background);
+    } else {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(background, &bufinfo, MP_BUFFER_READ);
+        if (bufinfo.len < (size_t)w * h * 2) {
+            mp_raise_ValueError(MP_ERROR_TEXT("background smaller than the bounding box"));
+        }
+        bg->buf = bufinfo.buf;
+    }
+}
+
+
+STATIC void bbox_render(rm67162_RM67162_obj_t *self, int x0, int y0, int w, int h, const rm67162_background_t *bg, rm67162_band_fn_t fn, void *ctx) {
+    int cx0 = MAX(x0, 0);
+    int cy0 = MAX(y0, 0);
+    int cx1 = MIN(x0 + w - 1, self->max_width_value);
+    int cy1 = MIN(y0 + h - 1, self->max_height_value);
+    if (cx0 > cx1 || cy0 > cy1) {
+        return;
+    }
+    int cw = cx1 - cx0 + 1;
+
+    size_t size = cw * (cy1 - cy0 + 1) * 2;
+    uint16_t *band = scratch_get(self, cw * 2, &size);
+    int band_rows = size / (cw * 2);
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        scratch_put(self, band);
+        nlr_jump(nlr.ret_val);
+    }
+
+    for (int y = cy0; y <= cy1; y += band_rows) {
+        int rows = MIN(band_rows, cy1 - y + 1);
+        for (int row = 0; row < rows; row++) {
+            uint16_t *dst = band + row * cw;
+            if (bg->buf) {
+                memcpy(dst, bg->buf + (y + row - y0) * w + (cx0 - x0), cw * 2);
+            } else {
+                for (int i = 0; i < cw; i++) {
+                    dst[i] = bg->color;
+                }
+            }
+        }
+        fn(ctx, band, cx0, y, cw, rows);
+        if (self->use_frame_buffer) {
+            fb_write(self, cx0, y, cx1, y + rows - 1, band, rows * cw);
+        } else if (set_area(self, cx0, y, cx1, y + rows - 1)) {
+            write_color(self, band, rows * cw * 2);
+        }
+    }
+
+    nlr_pop();
+    scratch_put(self, band);
+}
+
+
+STATIC void spans_band_fn(void *ctx, uint16_t *band, int x0, int y0, int w, int rows) {
+    rm67162_spans_t *spans = ctx;
+    for (int y = MAX(y0, spans->y0); y < MIN(y0 + rows, spans->y0 + spans->rows); y++) {
+        int16_t *run = spans->run + (y - spans->y0) * 4;
+        uint16_t *dst = band + (y - y0) * w;
+        for (int k = 0; k < 4; k += 2) {
+            for (int x = MAX(run[k], x0); x <= MIN(run[k + 1], x0 + w - 1); x++) {
+                dst[x - x0] = spans->color;
+            }
+        }
+    }
+}
+
+
+// Sends the spans over the bounding box x, y, w, h of the shape with the
+// background, or without a background as spans_end() does.
+STATIC void spans_render(rm67162_RM67162_obj_t *self, rm67162_spans_t *spans, uint16_t color, int x, int y, int w, int h, const rm67162_background_t *bg) {
+    if (bg == NULL) {
+        spans_end(self, spans, color);
+        return;
+    }
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        scratch_put(self, spans->run);
+        nlr_jump(nlr.ret_val);
+    }
+    spans->color = color;
+    bbox_render(self, x, y, w, h, bg, spans_band_fn, spans);
+    nlr_pop();
+    scratch_put(self, spans->run);
+}
+
+
+STATIC void fast_hline(rm67162_RM67162_obj_t *self, int x, int y, uint16_t l, uint16_t color) {
+    if (y < 0) {
+        return;
+    }
+    if (l == 0) {
+        return;
+    }
+
+    if (l == 1) {
+        draw_pixel(self, x, y, color);
+    } else {
+        if (x < 0) {
+            l += x;
+            x = 0;
+        }
+        if (x > self->max_width_value) {
+            x = self->max_width_value; // This is to prevent overflow that could occur at *1
+        }
+        if (x + l > self->max_width_value) {
+            l = self->max_width_value - x; // *1
+        } 
+        fill_color_buffer(self, color, x, y, l, 1);
+    }
+}
+
+
+STATIC void fast_vline(rm67162_RM67162_obj_t *self, int x, int y, uint16_t l, uint16_t color) {
+    if (x < 0) {
+        return;
+    }
+    if (l == 0) {
+        return;
+    }
+
+    if (l == 1) {
+        draw_pixel(self, x, y, color);
+    } else {
+        if (y < 0) {
+            l += y;
+            y = 0;
+        }
+        if (y > self->max_width_value) {
+            y = self->max_width_value; // This is to prevent overflow that could occur at *2
+        }
+        if (y + l > self->max_height_value) {
+            l = self->max_height_value - y; // *2
+        }
+        fill_color_buffer(self, color, x, y, 1, l + 1);
+    }
+}
+
+STATIC mp_obj_t rm67162_RM67162_hline(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    int x = mp_obj_get_int(args_in[1]);
+    int y = mp_obj_get_int(args_in[2]);
+    uint16_t l = mp_obj_get_int(args_in[3]);
+    uint16_t color = mp_obj_get_int(args_in[4]);
+
+    fast_hline(self, x, y, l, color);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_hline_obj, 5, 5, rm67162_RM67162_hline);
+
+
+STATIC mp_obj_t rm67162_RM67162_vline(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    int x = mp_obj_get_int(args_in[1]);
+    int y = mp_obj_get_int(args_in[2]);
+    uint16_t l = mp_obj_get_int(args_in[3]);
+    uint16_t color = mp_obj_get_int(args_in[4]);
+
+    fast_vline(self, x, y, l, color);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_vline_obj, 5, 5, rm67162_RM67162_vline);
+
+
+
+STATIC void rect(rm67162_RM67162_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t l, uint16_t color) {
+    fast_hline(self, x, y, w - 1, color);
+    fast_hline(self, x, y + l - 1, w - 1, color);
+    fast_vline(self, x, y, l - 1, color);
+    fast_vline(self, x + w - 1, y, l - 1, color);
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_rect(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    uint16_t x = mp_obj_get_int(args_in[1]);
+    uint16_t y = mp_obj_get_int(args_in[2]);
+    uint16_t w = mp_obj_get_int(args_in[3]);
+    uint16_t l = mp_obj_get_int(args_in[4]);
+    uint16_t color = mp_obj_get_int(args_in[5]);
+
+    rect(self, x, y, w, l, color);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_rect_obj, 6, 6, rm67162_RM67162_rect);
+
+
+STATIC void fill_rect(rm67162_RM67162_obj_t *self, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    // set_area(self, x, y, x + w - 1, y + h - 1);
+    fill_color_buffer(self, color, x, y, w, h);
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_fill_rect(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    uint16_t x = mp_obj_get_int(args_in[1]);
+    uint16_t y = mp_obj_get_int(args_in[2]);
+    uint16_t w = mp_obj_get_int(args_in[3]);
+    uint16_t l = mp_obj_get_int(args_in[4]);
+    uint16_t color = mp_obj_get_int(args_in[5]);
+
+    fill_rect(self, x, y, w, l, color);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_rect_obj, 6, 6, rm67162_RM67162_fill_rect);
+
+STATIC void fill_bubble_rect(rm67162_RM67162_obj_t *self, int xs, int ys, int w, int h, uint16_t color) {
+    if (xs + w > self->width || ys + h > self->height) {
+        return;
+    }
+    int bubble_size;
+    if (w < h) {
+        bubble_size = w / 4;
+    } else {
+        bubble_size = h / 4;
+    }
+    
+    int xm = xs + bubble_size;
+    int ym = ys + bubble_size;
+    int x = 0;
+    int y = bubble_size;
+    int p = 1 - bubble_size;
+    
+    if ((w < (bubble_size * 2)) | (h < (bubble_size * 2))){
+        return;
+    }
+
+    rm67162_spans_t spans;
+    spans_begin(self, &spans, ys, h, xs + w / 2);
+    for (int row = ys + bubble_size - 1; row < ys + h - bubble_size - 1; row++) {
+        spans_add(&spans, xs, xs + w - 1, row);
+    }
+
+    while (x <= y) {
+        // top left to right
+        spans_add(&spans, xm - x, xm - x + w - bubble_size * 2 + x * 2 - 2, ym - y);
+        spans_add(&spans, xm - y, xm - y + w - bubble_size * 2 + y * 2 - 2, ym - x);
+        
+        // bottom left to right
+        spans_add(&spans, xm - x, xm - x + w - bubble_size * 2 + x * 2 - 2, ym + h - bubble_size * 2 + y - 1);
+        spans_add(&spans, xm - y, xm - y + w - bubble_size * 2 + y * 2 - 2, ym + h - bubble_size * 2 + x - 1);
+        
+        if (p < 0) {
+            p += 2 * x + 3;
+        } else {
+            p += 2 * (x - y) + 5;
+            y -= 1;
+        } 
+        x += 1;
+    }
+    spans_end(self, &spans, color);
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_fill_bubble_rect(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    int xs = mp_obj_get_int(args_in[1]);
+    int ys = mp_obj_get_int(args_in[2]);
+    int w = mp_obj_get_int(args_in[3]);
+    int h = mp_obj_get_int(args_in[4]);
+    uint16_t color = mp_obj_get_int(args_in[5]);
+
+    fill_bubble_rect(self, xs, ys, w, h, color);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_bubble_rect_obj, 6, 6, rm67162_RM67162_fill_bubble_rect);
+
+STATIC void bubble_rect(rm67162_RM67162_obj_t *self, int xs, int ys, int w, int h, uint16_t color, const rm67162_background_t *bg) {
+    if (xs + w > self->width || ys + h > self->height) {
+        return;
+    }
+    int bubble_size;
+    if (w < h) {
+        bubble_size = w / 4;
+    } else {
+        bubble_size = h / 4;
+    }
+    
+    int xm = xs + bubble_size;
+    int ym = ys + bubble_size;
+    int x = 0;
+    int y = bubble_size;
+    int p = 1 - bubble_size;
+    
+    if ((w < (bubble_size * 2)) | (h < (bubble_size * 2))){
+        return;
+    }
+
+    rm67162_spans_t spans;
+    spans_begin(self, &spans, ys, h, xs + w / 2);
+    spans_add(&spans, xs + bubble_size - 1, xs + w - bubble_size - 2, ys);
+    spans_add(&spans, xs + bubble_size - 1, xs + w - bubble_size - 2, ys + h - 1);
+    for (int row = ys + bubble_size - 1; row <= ys + h - bubble_size - 1; row++) {
+        spans_add(&spans, xs, xs, row);
+        spans_add(&spans, xs + w - 1, xs + w - 1, row);
+    }
+
+    while (x <= y){
+        // top left
+        spans_add(&spans, xm - x, xm - x, ym - y);
+        spans_add(&spans, xm - y, xm - y, ym - x);
+        
+        // top right
+        spans_add(&spans, xm + w - bubble_size * 2 + x - 1, xm + w - bubble_size * 2 + x - 1, ym - y);
+        spans_add(&spans, xm + w - bubble_size * 2 + y - 1, xm + w - bubble_size * 2 + y - 1, ym - x);
+        
+        // bottom left
+        spans_add(&spans, xm - x, xm - x, ym + h - bubble_size * 2 + y - 1);
+        spans_add(&spans, xm - y, xm - y, ym + h - bubble_size * 2 + x - 1);
+        
+        // bottom right
+        spans_add(&spans, xm + w - bubble_size * 2 + x - 1, xm + w - bubble_size * 2 + x - 1, ym + h - bubble_size * 2 + y - 1);
+        spans_add(&spans, xm + w - bubble_size * 2 + y - 1, xm + w - bubble_size * 2 + y - 1, ym + h - bubble_size * 2 + x - 1);
+        
+        if (p < 0) {
+            p += 2 * x + 3;
+        } else {
+            p += 2 * (x - y) + 5;
+            y -= 1;
+        }
+        x += 1;
+    }
+    spans_render(self, &spans, color, xs, ys, w, h, bg);
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_bubble_rect(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    int xs = mp_obj_get_int(args_in[1]);
+    int ys = mp_obj_get_int(args_in[2]);
+    int w = mp_obj_get_int(args_in[3]);
+    int h = mp_obj_get_int(args_in[4]);
+    uint16_t color = mp_obj_get_int(args_in[5]);
+
+    if (n_args > 6) {
+        rm67162_background_t bg;
+        get_background(args_in[6], &bg, w, h);
+        bubble_rect(self, xs, ys, w, h, color, &bg);
+    } else {
+        bubble_rect(self, xs, ys, w, h, color, NULL);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_bubble_rect_obj, 6, 7, rm67162_RM67162_bubble_rect);
+
+
+/*
+Similar to: https://en.wikipedia.org/wiki/Midpoint_circle_algorithm
+*/
+STATIC void circle(rm67162_RM67162_obj_t *self, int xm, int ym, int r, uint16_t color, const rm67162_background_t *bg) {
+    int x = 0;
+    int y = r;
+    int p = 1 - r;
+
+    if (r < 0) {
+        return;
+    }
+
+    // every row holds one run of the arc left of xm and one right of it
+    rm67162_spans_t spans;
+    spans_begin(self, &spans, ym - r, 2 * r + 1, xm);
+    while (x <= y) {
+        spans_add(&spans, xm + x, xm + x, ym + y);
+        spans_add(&spans, xm + x, xm + x, ym - y);
+        spans_add(&spans, xm - x, xm - x, ym + y);
+        spans_add(&spans, xm - x, xm - x, ym - y);
+        spans_add(&spans, xm + y, xm + y, ym + x);
+        spans_add(&spans, xm + y, xm + y, ym - x);
+        spans_add(&spans, xm - y, xm - y, ym + x);
+        spans_add(&spans, xm - y, xm - y, ym - x);
+
+        if (p < 0) {
+            p += 2 * x + 3;
+        } else {
+            p += 2 * (x - y) + 5;
+            y -= 1;
+        }
+        x += 1;
+    }
+    spans_render(self, &spans, color, xm - r, ym - r, 2 * r + 1, 2 * r + 1, bg);
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_circle(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    int xm = mp_obj_get_int(args_in[1]);
+    int ym = mp_obj_get_int(args_in[2]);
+    int r = mp_obj_get_int(args_in[3]);
+    uint16_t color = mp_obj_get_int(args_in[4]);
+
+    if (n_args > 5) {
+        rm67162_background_t bg;
+        get_background(args_in[5], &bg, 2 * r + 1, 2 * r + 1);
+        circle(self, xm, ym, r, color, &bg);
+    } else {
+        circle(self, xm, ym, r, color, NULL);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_circle_obj, 5, 6, rm67162_RM67162_circle);
+
+
+STATIC void fill_circle(rm67162_RM67162_obj_t *self, int xm, int ym, int r, uint16_t color) {
+    int x = 0;
+    int y = r;
+    int p = 1 - r;
+
+    if (r < 0) {
+        return;
+    }
+
+    rm67162_spans_t spans;
+    spans_begin(self, &spans, ym - r, 2 * r + 1, xm);
+    while (x <= y) {
+        spans_add(&spans, xm - x, xm + x, ym - y);
+        spans_add(&spans, xm - x, xm + x, ym + y);
+        spans_add(&spans, xm - y, xm + y, ym - x);
+        spans_add(&spans, xm - y, xm + y, ym + x);
+
+        if (p < 0) {
+            p += 2 * x + 3;
+        } else {
+            p += 2 * (x - y) + 5;
+            y -= 1;
+        }
+        x += 1;
+    }
+    spans_end(self, &spans, color);
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_fill_circle(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    int xm = mp_obj_get_int(args_in[1]);
+    int ym = mp_obj_get_int(args_in[2]);
+    int r = mp_obj_get_int(args_in[3]);
+    uint16_t color = mp_obj_get_int(args_in[4]);
+
+    fill_circle(self, xm, ym, r, color);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_circle_obj, 5, 5, rm67162_RM67162_fill_circle);
+
+
+STATIC void line(rm67162_RM67162_obj_t *self, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color) {
+    bool steep = ABS(y1 - y0) > ABS(x1 - x0);
     if (steep) {
         _swap_int16_t(x0, y0);
         _swap_int16_t(x1, y1);
     }
 
-    if (x0 > x1) {
-        _swap_int16_t(x0, x1);
-        _swap_int16_t(y0, y1);
+    if (x0 > x1) {
+        _swap_int16_t(x0, x1);
+        _swap_int16_t(y0, y1);
+    }
+
+    int16_t dx = x1 - x0, dy = ABS(y1 - y0);
+    int16_t err = dx >> 1, ystep = -1, xs = x0, dlen = 0;
+
+    if (y0 < y1) {
+        ystep = 1;
+    }
+
+    batch_begin(self);
+    // Split into steep and not steep for FastH/V separation
+    if (steep) {
+        for (; x0 <= x1; x0++) {
+            dlen++;
+            err -= dy;
+            if (err < 0) {
+                err += dx;
+                fast_vline(self, y0, xs, dlen, color);
+                dlen = 0;
+                y0 += ystep;
+                xs = x0 + 1;
+            }
+        }
+        if (dlen) {
+            fast_vline(self, y0, xs, dlen, color);
+        }
+    } else {
+        for (; x0 <= x1; x0++) {
+            dlen++;
+            err -= dy;
+            if (err < 0) {
+                err += dx;
+                fast_hline(self, xs, y0, dlen, color);
+                dlen = 0;
+                y0 += ystep;
+                xs = x0 + 1;
+            }
+        }
+        if (dlen) {
+            fast_hline(self, xs, y0, dlen, color);
+        }
+    }
+    batch_end(self);
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_line(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    uint16_t x0 = mp_obj_get_int(args_in[1]);
+    uint16_t y0 = mp_obj_get_int(args_in[2]);
+    uint16_t x1 = mp_obj_get_int(args_in[3]);
+    uint16_t y1 = mp_obj_get_int(args_in[4]);
+    uint16_t color = mp_obj_get_int(args_in[5]);
+
+    line(self, x0, y0, x1, y1, color);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_line_obj, 6, 6, rm67162_RM67162_line);
+
+
+// Returns the records of an array('h') or array('H') holding fields int16
+// values each, *count is set to the number of records.
+STATIC const int16_t *get_records(mp_obj_t buf_in, size_t fields, size_t *count) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
+    if (bufinfo.typecode != 'h' && bufinfo.typecode != 'H') {
+        mp_raise_ValueError(MP_ERROR_TEXT("records must be array('h') or array('H')"));
+    }
+
+    size_t len = bufinfo.len / sizeof(int16_t);
+    if (len % fields) {
+        mp_raise_ValueError(MP_ERROR_TEXT("incomplete record"));
+    }
+    *count = len / fields;
+    return bufinfo.buf;
+}
+
+
+// Clips a rectangle to the display, returns false if nothing is left.
+STATIC bool clip_rect(rm67162_RM67162_obj_t *self, int *x, int *y, int *w, int *h) {
+    if (*x < 0) {
+        *w += *x;
+        *x = 0;
+    }
+    if (*y < 0) {
+        *h += *y;
+        *y = 0;
+    }
+    *w = MIN(*w, self->width - *x);
+    *h = MIN(*h, self->height - *y);
+    return *w > 0 && *h > 0;
+}
+
+
+// Outcode of a point for clip_line(), a bit per side of the display it lies beyond.
+STATIC int clip_code(rm67162_RM67162_obj_t *self, int x, int y) {
+    return ((x < 0) ? 1 : 0) | ((x >= self->width) ? 2 : 0) |
+           ((y < 0) ? 4 : 0) | ((y >= self->height) ? 8 : 0);
+}
+
+
+// a * b / c rounded to the nearest integer, c != 0.
+STATIC int mul_div_round(int a, int b, int c) {
+    int64_t n = (int64_t)a * b;
+    if (c < 0) {
+        n = -n;
+        c = -c;
+    }
+    return (n >= 0) ? (n + c / 2) / c : -((-n + c / 2) / c);
+}
+
+
+// Clips a line to the display, Cohen-Sutherland, returns false if nothing is
+// left. The ends are moved along the line, rounded to the nearest pixel, so
+// a line grazing a corner may be given up after a few rounds.
+STATIC bool clip_line(rm67162_RM67162_obj_t *self, int *x0, int *y0, int *x1, int *y1) {
+    int code0 = clip_code(self, *x0, *y0);
+    int code1 = clip_code(self, *x1, *y1);
+
+    for (int round = 0; code0 | code1; round++) {
+        if ((code0 & code1) || round == 4) {
+            return false;
+        }
+        int code = (code0) ? code0 : code1;
+        int dx = *x1 - *x0;
+        int dy = *y1 - *y0;
+        int x, y;
+        if (code & 4) {
+            y = 0;
+            x = *x0 + mul_div_round(dx, y - *y0, dy);
+        } else if (code & 8) {
+            y = self->height - 1;
+            x = *x0 + mul_div_round(dx, y - *y0, dy);
+        } else if (code & 1) {
+            x = 0;
+            y = *y0 + mul_div_round(dy, x - *x0, dx);
+        } else {
+            x = self->width - 1;
+            y = *y0 + mul_div_round(dy, x - *x0, dx);
+        }
+        if (code == code0) {
+            *x0 = x;
+            *y0 = y;
+            code0 = clip_code(self, x, y);
+        } else {
+            *x1 = x;
+            *y1 = y;
+            code1 = clip_code(self, x, y);
+        }
+    }
+    return true;
+}
+
+
+// fill_rects(records[, color]) fills x, y, w, h, color records, or x, y, w, h
+// records in color, all in one batch.
+STATIC mp_obj_t rm67162_RM67162_fill_rects(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    size_t fields = (n_args > 2) ? 4 : 5;
+    size_t count;
+    const int16_t *rec = get_records(args_in[1], fields, &count);
+    uint16_t color = (n_args > 2) ? mp_obj_get_int(args_in[2]) : 0;
+
+    batch_begin(self);
+    for (size_t i = 0; i < count; i++, rec += fields) {
+        int x = rec[0], y = rec[1], w = rec[2], h = rec[3];
+        if (clip_rect(self, &x, &y, &w, &h)) {
+            fill_color_buffer(self, (fields == 5) ? (uint16_t)rec[4] : color, x, y, w, h);
+        }
+    }
+    batch_end(self);
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_rects_obj, 2, 3, rm67162_RM67162_fill_rects);
+
+
+// hlines(records[, color]) draws x, y, l, color records, or x, y, l records
+// in color, all in one batch.
+STATIC mp_obj_t rm67162_RM67162_hlines(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    size_t fields = (n_args > 2) ? 3 : 4;
+    size_t count;
+    const int16_t *rec = get_records(args_in[1], fields, &count);
+    uint16_t color = (n_args > 2) ? mp_obj_get_int(args_in[2]) : 0;
+
+    batch_begin(self);
+    for (size_t i = 0; i < count; i++, rec += fields) {
+        int x = rec[0], y = rec[1], w = rec[2], h = 1;
+        if (clip_rect(self, &x, &y, &w, &h)) {
+            fill_color_buffer(self, (fields == 4) ? (uint16_t)rec[3] : color, x, y, w, 1);
+        }
+    }
+    batch_end(self);
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_hlines_obj, 2, 3, rm67162_RM67162_hlines);
+
+
+// pixels(records[, color]) draws x, y, color records, or x, y records in
+// color, all in one batch.
+STATIC mp_obj_t rm67162_RM67162_pixels(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    size_t fields = (n_args > 2) ? 2 : 3;
+    size_t count;
+    const int16_t *rec = get_records(args_in[1], fields, &count);
+    uint16_t color = (n_args > 2) ? mp_obj_get_int(args_in[2]) : 0;
+
+    batch_begin(self);
+    for (size_t i = 0; i < count; i++, rec += fields) {
+        if (rec[0] >= 0 && rec[0] < self->width && rec[1] >= 0 && rec[1] < self->height) {
+            draw_pixel(self, rec[0], rec[1], (fields == 3) ? (uint16_t)rec[2] : color);
+        }
+    }
+    batch_end(self);
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_pixels_obj, 2, 3, rm67162_RM67162_pixels);
+
+
+// lines(records[, color]) draws x0, y0, x1, y1, color records, or x0, y0, x1,
+// y1 records in color, all in one batch.
+STATIC mp_obj_t rm67162_RM67162_lines(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    size_t fields = (n_args > 2) ? 4 : 5;
+    size_t count;
+    const int16_t *rec = get_records(args_in[1], fields, &count);
+    uint16_t color = (n_args > 2) ? mp_obj_get_int(args_in[2]) : 0;
+
+    batch_begin(self);
+    for (size_t i = 0; i < count; i++, rec += fields) {
+        // line() takes unsigned ends, so every line is clipped to the display
+        int x0 = rec[0], y0 = rec[1], x1 = rec[2], y1 = rec[3];
+        if (clip_line(self, &x0, &y0, &x1, &y1)) {
+            line(self, x0, y0, x1, y1, (fields == 5) ? (uint16_t)rec[4] : color);
+        }
+    }
+    batch_end(self);
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_lines_obj, 2, 3, rm67162_RM67162_lines);
+
+
+// Return the center of a polygon as an (x, y) tuple
+STATIC mp_obj_t rm67162_RM67162_polygon_center(size_t n_args, const mp_obj_t *args) {
+    size_t poly_len;
+    mp_obj_t *polygon;
+    mp_obj_get_array(args[1], &poly_len, &polygon);
+
+    mp_float_t sum = 0.0;
+    int vsx = 0;
+    int vsy = 0;
+
+    if (poly_len > 0) {
+        for (int idx = 0; idx < poly_len; idx++) {
+            size_t point_from_poly_len;
+            mp_obj_t *point_from_poly;
+            mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
+            if (point_from_poly_len < 2) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            }
+
+            mp_int_t v1x = mp_obj_get_int(point_from_poly[0]);
+            mp_int_t v1y = mp_obj_get_int(point_from_poly[1]);
+
+            mp_obj_get_array(polygon[(idx + 1) % poly_len], &point_from_poly_len, &point_from_poly);
+            if (point_from_poly_len < 2) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            }
+
+            mp_int_t v2x = mp_obj_get_int(point_from_poly[0]);
+            mp_int_t v2y = mp_obj_get_int(point_from_poly[1]);
+
+            mp_float_t cross = v1x * v2y - v1y * v2x;
+            sum += cross;
+            vsx += (int)((v1x + v2x) * cross);
+            vsy += (int)((v1y + v2y) * cross);
+        }
+
+        mp_float_t z = 1.0 / (3.0 * sum);
+        vsx = (int)(vsx * z);
+        vsy = (int)(vsy * z);
+    } else {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+    }
+
+    mp_obj_t center[2] = {mp_obj_new_int(vsx), mp_obj_new_int(vsy)};
+    return mp_obj_new_tuple(2, center);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_polygon_center_obj, 2, 2, rm67162_RM67162_polygon_center);
+
+
+static void RotatePolygon(Polygon *polygon, Point center, mp_float_t angle) {
+    if (polygon->length == 0) {
+        return;         /* reject null polygons */
+
+    }
+    mp_float_t cosAngle = MICROPY_FLOAT_C_FUN(cos)(angle);
+    mp_float_t sinAngle = MICROPY_FLOAT_C_FUN(sin)(angle);
+
+    for (int i = 0; i < polygon->length; i++) {
+        mp_float_t dx = (polygon->points[i].x - center.x);
+        mp_float_t dy = (polygon->points[i].y - center.y);
+
+        polygon->points[i].x = center.x + (int)0.5 + (dx * cosAngle - dy * sinAngle);
+        polygon->points[i].y = center.y + (int)0.5 + (dx * sinAngle + dy * cosAngle);
+    }
+}
+
+STATIC int edge_compare(const void *a, const void *b) {
+    return ((const rm67162_edge_t *)a)->y_start - ((const rm67162_edge_t *)b)->y_start;
+}
+
+
+// Floor division of num by den > 0, the remainder is returned in *rem.
+STATIC int32_t edge_divide(int64_t num, int32_t den, int32_t *rem) {
+    int64_t quot = num / den;
+    if (num % den < 0) {
+        quot--;
+    }
+    *rem = (int32_t)(num - quot * den);
+    return (int32_t)quot;
+}
+
+
+// Builds the edge table of the closed polygon through n 16.16 x, y pairs into
+// edges, rows are sampled top inclusive and bottom exclusive. Returns the
+// number of edges, horizontal ones and those between two rows are left out.
+STATIC int edge_table_build(const int32_t *points, int n, rm67162_edge_t *edges) {
+    int count = 0;
+
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        int32_t x0 = points[2 * j];
+        int32_t y0 = points[2 * j + 1];
+        int32_t x1 = points[2 * i];
+        int32_t y1 = points[2 * i + 1];
+        int8_t dir = 1;
+
+        if (y0 > y1) {
+            int32_t t = x0; x0 = x1; x1 = t;
+            t = y0; y0 = y1; y1 = t;
+            dir = -1;
+        }
+
+        int y_start = (y0 + 0xFFFF) >> 16;
+        int y_end = ((y1 + 0xFFFF) >> 16) - 1;
+        if (y_start > y_end) {
+            continue;
+        }
+
+        rm67162_edge_t *e = &edges[count++];
+        e->height = y1 - y0;
+        e->x = x0 + edge_divide((int64_t)(x1 - x0) * (((int32_t)y_start << 16) - y0), e->height, &e->error);
+        e->step = edge_divide((int64_t)(x1 - x0) << 16, e->height, &e->error_step);
+        e->y_start = y_start;
+        e->y_end = y_end;
+        e->dir = dir;
+    }
+    qsort(edges, count, sizeof(rm67162_edge_t), edge_compare);
+
+    return count;
+}
+
+
+// Scanline fill of an edge table moved by (dx, dy): edges enter the active
+// list at their first row and leave after their last one. The crossings of a
+// row are paired by the fill rule and touching spans are merged before they
+// are sent. The edges are stepped in place, active holds count pointers.
+STATIC void edge_table_fill(rm67162_RM67162_obj_t *self, rm67162_edge_t *edges, int count, rm67162_edge_t **active, int dx, int dy, uint16_t color, int rule) {
+    for (int i = 0; i < count; i++) {
+        edges[i].x += dx << 16;
+        edges[i].y_start += dy;
+        edges[i].y_end += dy;
+    }
+
+    int next = 0;
+    int n_active = 0;
+    int y = count ? edges[0].y_start : 0;
+
+    batch_begin(self);
+    while ((next < count || n_active) && y <= self->max_height_value) {
+        if (n_active == 0 && edges[next].y_start > y) {
+            y = edges[next].y_start;
+        }
+        while (next < count && edges[next].y_start == y) {
+            active[n_active++] = &edges[next++];
+        }
+
+        // the order barely changes between rows
+        for (int i = 1; i < n_active; i++) {
+            rm67162_edge_t *e = active[i];
+            int j = i;
+            for (; j > 0 && active[j - 1]->x > e->x; j--) {
+                active[j] = active[j - 1];
+            }
+            active[j] = e;
+        }
+
+        if (y >= 0) {
+            int winding = 0;
+            int x_start = 0;
+            int span_x0 = 0;
+            int span_x1 = -1;
+
+            for (int i = 0; i < n_active; i++) {
+                bool inside = (rule == RM67162_NON_ZERO) ? winding != 0 : (winding & 1);
+                winding += (rule == RM67162_NON_ZERO) ? active[i]->dir : 1;
+                bool now_inside = (rule == RM67162_NON_ZERO) ? winding != 0 : (winding & 1);
+                int x = active[i]->x >> 16;
+
+                if (!inside && now_inside) {
+                    x_start = x;
+                } else if (inside && !now_inside) {
+                    if (span_x1 < span_x0 || x_start > span_x1 + 1) {
+                        if (span_x1 >= span_x0) {
+                            fast_hline(self, span_x0, y, span_x1 - span_x0 + 1, color);
+                        }
+                        span_x0 = x_start;
+                    }
+                    span_x1 = MAX(span_x1, x);
+                }
+            }
+            if (span_x1 >= span_x0) {
+                fast_hline(self, span_x0, y, span_x1 - span_x0 + 1, color);
+            }
+        }
+
+        y++;
+        int kept = 0;
+        for (int i = 0; i < n_active; i++) {
+            rm67162_edge_t *e = active[i];
+            if (e->y_end >= y) {
+                e->x += e->step;
+                e->error += e->error_step;
+                if (e->error >= e->height) {
+                    e->error -= e->height;
+                    e->x++;
+                }
+                active[kept++] = e;
+            }
+        }
+        n_active = kept;
+    }
+    batch_end(self);
+}
+
+
+// Fills the polygon through n 16.16 x, y pairs moved by (x, y). A Shape passes
+// its cached edge table, which is copied as the fill steps the edges.
+STATIC void PolygonFill(rm67162_RM67162_obj_t *self, const int32_t *points, int n, rm67162_shape_obj_t *shape, int x, int y, uint16_t color, int rule) {
+    size_t size = n * (sizeof(rm67162_edge_t) + sizeof(rm67162_edge_t *));
+    rm67162_edge_t *edges = scratch_get(self, size, &size);
+    int count;
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        scratch_put(self, edges);
+        nlr_jump(nlr.ret_val);
+    }
+
+    if (shape) {
+        if (!shape->edges_valid) {
+            shape->edge_count = edge_table_build(shape->fixed, shape->length, shape->edges);
+            shape->edges_valid = true;
+        }
+        count = shape->edge_count;
+        memcpy(edges, shape->edges, count * sizeof(rm67162_edge_t));
+    } else {
+        count = edge_table_build(points, n, edges);
+    }
+    edge_table_fill(self, edges, count, (rm67162_edge_t **)(edges + n), x, y, color, rule);
+
+    nlr_pop();
+    scratch_put(self, edges);
+}
+
+
+// Quarter of a sine wave in RM67162_SINE_STEPS per turn, 1.0 is 32768.
+STATIC const uint16_t sine_table[RM67162_SINE_STEPS / 4 + 1] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210,
+    2411, 2611, 2811, 3012, 3212, 3412, 3612, 3812, 4011, 4211, 4410, 4609,
+    4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195, 6393, 6590, 6787, 6983,
+    7180, 7376, 7571, 7767, 7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319,
+    9512, 9704, 9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605,
+    11793, 11980, 12167, 12354, 12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828,
+    14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269, 15447, 15624, 15800, 15976,
+    16151, 16326, 16500, 16673, 16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+    18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001,
+    20160, 20318, 20475, 20632, 20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+    22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028, 23170, 23312, 23453, 23593,
+    23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+    25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199, 26320, 26439, 26557, 26674,
+    26791, 26906, 27020, 27133, 27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002,
+    28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803, 28899, 28993, 29086, 29178,
+    29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+    30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784, 30853, 30920, 30986, 31050,
+    31114, 31177, 31238, 31298, 31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737,
+    31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099, 32138, 32177, 32214, 32251,
+    32286, 32319, 32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+    32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738, 32746, 32753,
+    32758, 32762, 32766, 32767, 32768,
+};
+
+
+STATIC int32_t shape_sin(int angle) {
+    angle &= RM67162_SINE_STEPS - 1;
+    int idx = angle % (RM67162_SINE_STEPS / 4);
+
+    switch (angle / (RM67162_SINE_STEPS / 4)) {
+        case 0:
+            return sine_table[idx];
+        case 1:
+            return sine_table[RM67162_SINE_STEPS / 4 - idx];
+        case 2:
+            return -sine_table[idx];
+        default:
+            return -sine_table[RM67162_SINE_STEPS / 4 - idx];
+    }
+}
+
+
+// Rotates the given points of a Shape into shape->fixed unless they already
+// are, the edge table is rebuilt by the next fill.
+STATIC void shape_rotate(rm67162_shape_obj_t *shape, int angle, int cx, int cy) {
+    angle &= RM67162_SINE_STEPS - 1;
+    if (angle == shape->angle && cx == shape->cx && cy == shape->cy) {
+        return;
+    }
+
+    int32_t sin_a = shape_sin(angle);
+    int32_t cos_a = shape_sin(angle + RM67162_SINE_STEPS / 4);
+
+    for (int i = 0; i < shape->length; i++) {
+        int64_t dx = shape->points[2 * i] - cx;
+        int64_t dy = shape->points[2 * i + 1] - cy;
+        shape->fixed[2 * i] = ((int32_t)cx << 16) + (int32_t)((dx * cos_a - dy * sin_a) << 1);
+        shape->fixed[2 * i + 1] = ((int32_t)cy << 16) + (int32_t)((dx * sin_a + dy * cos_a) << 1);
     }
 
-    int16_t dx = x1 - x0, dy = ABS(y1 - y0);
-    int16_t err = dx >> 1, ystep = -1, xs = x0, dlen = 0;
+    shape->angle = angle;
+    shape->cx = cx;
+    shape->cy = cy;
+    shape->edges_valid = false;
+}
+
+
+// The points of the polygon() and fill_polygon() arguments as 16.16 x, y
+// pairs rotated by args[5] radians around (args[6], args[7]). A Shape is
+// rotated in place and returned in *shape, a list is converted into the
+// scratch slot self->work.
+STATIC const int32_t *polygon_points(rm67162_RM67162_obj_t *self, size_t n_args, const mp_obj_t *args, int *len, rm67162_shape_obj_t **shape) {
+    mp_float_t angle = 0.0f;
+    if (n_args > 5) {
+        angle = mp_obj_get_float(args[5]);
+    }
+
+    if (mp_obj_is_type(args[1], &rm67162_shape_type)) {
+        *shape = MP_OBJ_TO_PTR(args[1]);
+        int cx = (*shape)->center_x;
+        int cy = (*shape)->center_y;
+        if (n_args > 6) {
+            cx = mp_obj_get_int(args[6]);
+            cy = mp_obj_get_int(args[7]);
+        }
+        int steps = (int)MICROPY_FLOAT_C_FUN(floor)(angle * RM67162_SINE_STEPS / (2 * MP_PI) + 0.5f);
+        shape_rotate(*shape, steps, cx, cy);
+        *len = (*shape)->length;
+        return (*shape)->fixed;
+    }
+    *shape = NULL;
+
+    size_t poly_len;
+    mp_obj_t *polygon;
+    mp_obj_get_array(args[1], &poly_len, &polygon);
+    if (poly_len == 0) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+    }
+
+    size_t work_size = poly_len * sizeof(Point);
+    self->work = scratch_get(self, work_size, &work_size);
+    Point *point = (Point *)self->work;
+
+    for (int idx = 0; idx < poly_len; idx++) {
+        size_t point_from_poly_len;
+        mp_obj_t *point_from_poly;
+        mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
+        if (point_from_poly_len < 2) {
+            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+        }
+
+        point[idx].x = mp_obj_get_int(point_from_poly[0]);
+        point[idx].y = mp_obj_get_int(point_from_poly[1]);
+    }
+
+    if (angle != 0) {
+        Point center = {0, 0};
+        if (n_args > 6) {
+            center.x = mp_obj_get_int(args[6]);
+            center.y = mp_obj_get_int(args[7]);
+        }
+        Polygon polygon = {poly_len, point};
+        RotatePolygon(&polygon, center, angle);
+    }
+
+    // in place, a pair is never larger than the Point it is made of
+    int32_t *fixed = self->work;
+    for (int idx = 0; idx < poly_len; idx++) {
+        mp_float_t px = point[idx].x;
+        mp_float_t py = point[idx].y;
+        fixed[2 * idx] = (int32_t)(px * 65536);
+        fixed[2 * idx + 1] = (int32_t)(py * 65536);
+    }
+
+    *len = poly_len;
+    return fixed;
+}
+
+
+// Context of polygon_band_fn(), the outline through points moved by (x, y).
+typedef struct _rm67162_outline_t {
+    const int32_t *points;
+    int length;
+    int x;
+    int y;
+    uint16_t color;
+} rm67162_outline_t;
+
+
+// Pixel coordinate of a 16.16 value, rounded to the nearest.
+#define POINT_INT(v) (((v) + 0x8000) >> 16)
+
+
+STATIC void polygon_band_fn(void *ctx, uint16_t *band, int x0, int y0, int w, int rows) {
+    rm67162_outline_t *outline = ctx;
+    for (int idx = 1; idx < outline->length; idx++) {
+        int xa = POINT_INT(outline->points[2 * idx - 2]) + outline->x;
+        int ya = POINT_INT(outline->points[2 * idx - 1]) + outline->y;
+        int xb = POINT_INT(outline->points[2 * idx]) + outline->x;
+        int yb = POINT_INT(outline->points[2 * idx + 1]) + outline->y;
+        if (MAX(ya, yb) < y0 || MIN(ya, yb) >= y0 + rows) {
+            continue;
+        }
+
+        int dx = ABS(xb - xa);
+        int dy = -ABS(yb - ya);
+        int sx = (xa < xb) ? 1 : -1;
+        int sy = (ya < yb) ? 1 : -1;
+        int err = dx + dy;
+        for (;;) {
+            if (xa >= x0 && xa < x0 + w && ya >= y0 && ya < y0 + rows) {
+                band[(ya - y0) * w + xa - x0] = outline->color;
+            }
+            if (xa == xb && ya == yb) {
+                break;
+            }
+            int e2 = 2 * err;
+            if (e2 >= dy) {
+                err += dy;
+                xa += sx;
+            }
+            if (e2 <= dx) {
+                err += dx;
+                ya += sy;
+            }
+        }
+    }
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_polygon(size_t n_args, const mp_obj_t *args) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
+    mp_int_t color = mp_obj_get_int(args[4]);
+
+    self->work = NULL;
+
+    // the slot has to be returned if the points raise
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        int poly_len;
+        rm67162_shape_obj_t *shape;
+        const int32_t *point = polygon_points(self, n_args, args, &poly_len, &shape);
+
+        if (n_args > 8) {
+            // the bounding box of the moved points
+            int x0 = INT16_MAX, y0 = INT16_MAX, x1 = INT16_MIN, y1 = INT16_MIN;
+            for (int idx = 0; idx < poly_len; idx++) {
+                x0 = MIN(x0, POINT_INT(point[2 * idx]) + x);
+                y0 = MIN(y0, POINT_INT(point[2 * idx + 1]) + y);
+                x1 = MAX(x1, POINT_INT(point[2 * idx]) + x);
+                y1 = MAX(y1, POINT_INT(point[2 * idx + 1]) + y);
+            }
+            rm67162_background_t bg;
+            get_background(args[8], &bg, x1 - x0 + 1, y1 - y0 + 1);
+            rm67162_outline_t outline = { point, poly_len, x, y, color };
+            bbox_render(self, x0, y0, x1 - x0 + 1, y1 - y0 + 1, &bg, polygon_band_fn, &outline);
+        } else {
+            batch_begin(self);
+            for (int idx = 1; idx < poly_len; idx++) {
+                line(
+                    self,
+                    POINT_INT(point[2 * idx - 2]) + x,
+                    POINT_INT(point[2 * idx - 1]) + y,
+                    POINT_INT(point[2 * idx]) + x,
+                    POINT_INT(point[2 * idx + 1]) + y, color);
+            }
+            batch_end(self);
+        }
+
+        nlr_pop();
+    } else {
+        scratch_put(self, self->work);
+        self->work = NULL;
+        nlr_jump(nlr.ret_val);
+    }
+    scratch_put(self, self->work);
+    self->work = NULL;
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_polygon_obj, 4, 9, rm67162_RM67162_polygon);
+
+
+STATIC mp_obj_t rm67162_RM67162_fill_polygon(size_t n_args, const mp_obj_t *args) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
+    mp_int_t color = mp_obj_get_int(args[4]);
+
+    mp_int_t rule = RM67162_EVEN_ODD;
+    if (n_args > 8) {
+        rule = mp_obj_get_int(args[8]);
+    }
+
+    self->work = NULL;
+
+    // the slot has to be returned if the points raise
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        int poly_len;
+        rm67162_shape_obj_t *shape;
+        const int32_t *point = polygon_points(self, n_args, args, &poly_len, &shape);
+        PolygonFill(self, point, poly_len, shape, x, y, color, rule);
+
+        nlr_pop();
+    } else {
+        scratch_put(self, self->work);
+        self->work = NULL;
+        nlr_jump(nlr.ret_val);
+    }
+    scratch_put(self, self->work);
+    self->work = NULL;
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_polygon_obj, 4, 9, rm67162_RM67162_fill_polygon);
+
+
+// Shape(points[, cx, cy]) converts the points once for polygon() and
+// fill_polygon(), which rotate it around (cx, cy) unless given another center.
+// points is a list of (x, y) tuples or the x, y pairs packed into an
+// array('h') or little-endian int16 bytes.
+STATIC mp_obj_t rm67162_shape_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_points, ARG_cx, ARG_cy };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_points, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_cx,     MP_ARG_INT,                   {.u_int = 0}           },
+        { MP_QSTR_cy,     MP_ARG_INT,                   {.u_int = 0}           },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(
+        n_args,
+        n_kw,
+        all_args,
+        MP_ARRAY_SIZE(allowed_args),
+        allowed_args,
+        args
+    );
+
+    mp_obj_t points = args[ARG_points].u_obj;
+    mp_buffer_info_t bufinfo;
+    mp_obj_t *items = NULL;
+    size_t len;
+
+    if (mp_get_buffer(points, &bufinfo, MP_BUFFER_READ)) {
+        if (bufinfo.typecode != 'h' && bufinfo.typecode != 'B' && bufinfo.typecode != BYTEARRAY_TYPECODE) {
+            mp_raise_ValueError(MP_ERROR_TEXT("points must be array('h') or bytes"));
+        }
+        len = bufinfo.len / 4;
+    } else {
+        mp_obj_get_array(points, &len, &items);
+    }
+    if (len == 0 || len > UINT16_MAX) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+    }
+
+    rm67162_shape_obj_t *self = m_new_obj(rm67162_shape_obj_t);
+    self->base.type = &rm67162_shape_type;
+    self->length = len;
+    self->points = m_new(int16_t, 2 * len);
+    self->fixed = m_new(int32_t, 2 * len);
+    self->edges = m_new(rm67162_edge_t, len);
+    self->edges_valid = false;
+
+    if (items == NULL) {
+        memcpy(self->points, bufinfo.buf, len * 4);
+    } else {
+        for (size_t idx = 0; idx < len; idx++) {
+            size_t point_len;
+            mp_obj_t *point;
+            mp_obj_get_array(items[idx], &point_len, &point);
+            if (point_len < 2) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            }
+            self->points[2 * idx] = mp_obj_get_int(point[0]);
+            self->points[2 * idx + 1] = mp_obj_get_int(point[1]);
+        }
+    }
+
+    // unrotated, so the first rotation always converts
+    self->angle = -1;
+    self->center_x = args[ARG_cx].u_int;
+    self->center_y = args[ARG_cy].u_int;
+    shape_rotate(self, 0, self->center_x, self->center_y);
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+
+STATIC void rm67162_shape_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void) kind;
+    rm67162_shape_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "<Shape points=%u, center=(%d, %d)>", self->length, self->center_x, self->center_y);
+}
+
+
+STATIC mp_obj_t rm67162_RM67162_bitmap(size_t n_args, const mp_obj_t *args_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+
+    int x_start = mp_obj_get_int(args_in[1]);
+    int y_start = mp_obj_get_int(args_in[2]);
+    int x_end   = mp_obj_get_int(args_in[3]);
+    int y_end   = mp_obj_get_int(args_in[4]);
+
+    x_start += self->x_gap;
+    x_end += self->x_gap;
+    y_start += self->y_gap;
+    y_end += self->y_gap;
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args_in[5], &bufinfo, MP_BUFFER_READ);
+    size_t len = ((x_end - x_start) * (y_end - y_start) * self->fb_bpp / 8);
+    if (len > bufinfo.len) {
+        len = bufinfo.len;
+    }
+
+    if (self->use_frame_buffer) {
+        fb_write(self, x_start, y_start, x_end, y_end, bufinfo.buf, len / 2);
+        return mp_const_none;
+    }
+    if (!set_area(self, x_start, y_start, x_end, y_end)) {
+        return mp_const_none;
+    }
+
+    // with block=False the transfer runs in the background, call wait() before reusing buf.
+    if (n_args > 6 && !mp_obj_is_true(args_in[6])) {
+        write_color_async(self, bufinfo.buf, len);
+        self->tx_obj = args_in[5];
+    } else {
+        write_color(self, bufinfo.buf, len);
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_bitmap_obj, 6, 7, rm67162_RM67162_bitmap);
+
+
+// bitmap_file(path, x, y, w, h) draws w * h color565 pixel in the byte order of
+// bitmap() read from a file, clipped to the display. The file is read in bands
+// into the two halves of a DMA buffer, so one band is read while the other is
+// sent in the background.
+STATIC mp_obj_t rm67162_RM67162_bitmap_file(size_t n_args, const mp_obj_t *args) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    int x = mp_obj_get_int(args[2]);
+    int y = mp_obj_get_int(args[3]);
+    int w = mp_obj_get_int(args[4]);
+    int h = mp_obj_get_int(args[5]);
+
+    int x0 = MAX(x, 0);
+    int x1 = MIN(x + w, (int)self->width);
+    int y0 = MAX(y, 0);
+    int y1 = MIN(y + h, (int)self->height);
+    if (w <= 0 || x0 >= x1 || y0 >= y1) {
+        return mp_const_none;
+    }
+    int cw = x1 - x0;
+    size_t row_size = w * 2;
+    if (!self->use_frame_buffer && !set_area(self, x0 + self->x_gap, y0 + self->y_gap, x1 - 1 + self->x_gap, y1 - 1 + self->y_gap)) {
+        return mp_const_none;
+    }
+
+    size_t size = 2 * row_size * (y1 - y0);
+    uint8_t *buffer = scratch_get(self, 2 * row_size, &size);
+    int band_rows = size / 2 / row_size;
+    uint8_t *bands[2] = { buffer, buffer + band_rows * row_size };
+
+    // opened under nlr_push() so the buffer is returned if that raises,
+    // volatile as it is assigned there
+    mp_obj_t volatile file = MP_OBJ_NULL;
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        file = mp_file_open(mp_obj_str_get_str(args[1]), "rb");
+        if (y0 > y) {
+            mp_file_seek(file, (mp_off_t)(y0 - y) * row_size, MP_SEEK_SET);
+        }
+
+        int band = 0;
+        for (int row = y0; row < y1; row += band_rows) {
+            int rows = MIN(band_rows, y1 - row);
+            // the transfer of this half was waited for when the other one started
+            uint8_t *p = bands[band];
+            rows = MIN(rows, (int)(mp_file_readinto(file, p, rows * row_size) / row_size));
+            if (rows == 0) {
+                break;
+            }
+            if (cw < w) {
+                for (int r = 0; r < rows; r++) {
+                    memmove(p + r * cw * 2, p + r * row_size + (x0 - x) * 2, cw * 2);
+                }
+            }
+
+            if (self->use_frame_buffer) {
+                fb_write(self, x0, row, x1 - 1, row + rows - 1, (const uint16_t *)p, rows * cw);
+            } else {
+                write_color_async(self, p, rows * cw * 2);
+            }
+            band ^= 1;
+        }
+        nlr_pop();
+    } else {
+        wait_color(self);
+        scratch_put(self, buffer);
+        if (file != MP_OBJ_NULL) {
+            mp_file_close(file);
+        }
+        nlr_jump(nlr.ret_val);
+    }
+
+    wait_color(self);
+    scratch_put(self, buffer);
+    mp_file_close(file);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_bitmap_file_obj, 6, 6, rm67162_RM67162_bitmap_file);
+
+
+// Input and output of the JPEG decoder in jpg().
+typedef struct _rm67162_jpg_t {
+    rm67162_RM67162_obj_t *self;
+    mp_obj_t file;              // MP_OBJ_NULL if decoded from data
+    const uint8_t *data;
+    size_t data_len;
+    int x;                      // of the image on the display
+    int y;
+    int x0;                     // visible columns on the display, x1 exclusive
+    int x1;
+    int width;                  // of the scaled image
+    uint16_t *bands[2];         // MCU rows, one is filled while the other is sent
+    int band;
+} rm67162_jpg_t;
+
+
+STATIC size_t jpg_in(JDEC *jd, uint8_t *buf, size_t len) {
+    rm67162_jpg_t *jpg = jd->device;
+    if (jpg->file != MP_OBJ_NULL) {
+        return mp_file_readinto(jpg->file, buf, len);
+    }
+    len = MIN(len, jpg->data_len);
+    memcpy(buf, jpg->data, len);
+    jpg->data += len;
+    jpg->data_len -= len;
+    return len;
+}
 
+
+// Copies the visible columns of an MCU into the band of its MCU row, which is
+// sent after the last MCU of the row. Stops the decoder below the display.
+STATIC int jpg_out(JDEC *jd, const uint16_t *pixels, const JRECT *rect) {
+    rm67162_jpg_t *jpg = jd->device;
+    rm67162_RM67162_obj_t *self = jpg->self;
+    int top = jpg->y + rect->top;
+    if (top >= self->height) {
+        return 0;
+    }
+
+    int w = rect->right - rect->left + 1;
+    int h = rect->bottom - rect->top + 1;
+    int bw = jpg->x1 - jpg->x0;
+    int left = MAX(jpg->x + rect->left, jpg->x0);
+    int right = MIN(jpg->x + rect->right + 1, jpg->x1);
+    uint16_t *band = jpg->bands[jpg->band];
+    for (int r = 0; r < h && left < right; r++) {
+        memcpy(band + r * bw + left - jpg->x0, pixels + r * w + left - jpg->x - rect->left, (right - left) * 2);
+    }
+    if (rect->right + 1 < jpg->width) {
+        return 1;
+    }
+
+    int y0 = MAX(top, 0);
+    int y1 = MIN(top + h, (int)self->height);
     if (y0 < y1) {
-        ystep = 1;
+        const uint16_t *p = band + (y0 - top) * bw;
+        if (self->use_frame_buffer) {
+            fb_write(self, jpg->x0, y0, jpg->x1 - 1, y1 - 1, p, (y1 - y0) * bw);
+        } else if (set_area(self, jpg->x0 + self->x_gap, y0 + self->y_gap, jpg->x1 - 1 + self->x_gap, y1 - 1 + self->y_gap)) {
+            // the next row is decoded into the other band meanwhile
+            write_color_async(self, p, (y1 - y0) * bw * 2);
+            jpg->band ^= 1;
+        }
+    }
+    return 1;
+}
+
+
+STATIC void jpg_raise(JRESULT res) {
+    switch (res) {
+        case JDR_FMT3:
+            mp_raise_ValueError(MP_ERROR_TEXT("unsupported JPEG"));
+            break;
+        case JDR_INP:
+            mp_raise_ValueError(MP_ERROR_TEXT("not a JPEG"));
+            break;
+        default:
+            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("JPEG data error"));
+            break;
+    }
+}
+
+
+// jpg(path_or_buffer, x, y[, scale]) draws a baseline JPEG at (x, y), scaled
+// down by 1, 2, 4 or 8 and clipped to the display. It is decoded one MCU at a
+// time and sent a row of MCUs at a time, the rows alternate between two bands
+// so one is decoded while the other is sent. Returns the drawn (width, height).
+STATIC mp_obj_t rm67162_RM67162_jpg(size_t n_args, const mp_obj_t *args) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    uint8_t scale = 0;
+    if (n_args > 4) {
+        mp_int_t divisor = mp_obj_get_int(args[4]);
+        while ((1 << scale) < divisor && scale < 3) {
+            scale++;
+        }
+        if ((1 << scale) != divisor) {
+            mp_raise_ValueError(MP_ERROR_TEXT("scale must be 1, 2, 4 or 8"));
+        }
+    }
+
+    rm67162_jpg_t jpg;
+    jpg.self = self;
+    jpg.x = mp_obj_get_int(args[2]);
+    jpg.y = mp_obj_get_int(args[3]);
+    jpg.file = MP_OBJ_NULL;
+    jpg.bands[0] = NULL;
+    jpg.band = 0;
+    if (mp_obj_is_str(args[1])) {
+        jpg.file = mp_file_open(mp_obj_str_get_str(args[1]), "rb");
+    } else {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+        jpg.data = bufinfo.buf;
+        jpg.data_len = bufinfo.len;
+    }
+
+    // the decoder state needs no DMA, the large slot is left to the bands
+    JDEC *jd = self->work = m_malloc(sizeof(JDEC));
+    size_t size;
+    int height = 0;
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        JRESULT res = jd_prepare(jd, jpg_in, &jpg);
+        if (res != JDR_OK) {
+            jpg_raise(res);
+        }
+        jpg.width = (jd->width + (1 << scale) - 1) >> scale;
+        height = (jd->height + (1 << scale) - 1) >> scale;
+        jpg.x0 = MAX(jpg.x, 0);
+        jpg.x1 = MIN(jpg.x + jpg.width, (int)self->width);
+
+        if (jpg.x0 < jpg.x1 && jpg.y < self->height && jpg.y + height > 0) {
+            size_t band_len = (jpg.x1 - jpg.x0) * (jd->msy * 8 >> scale);
+            size = 2 * band_len * 2;
+            jpg.bands[0] = scratch_get(self, size, &size);
+            jpg.bands[1] = jpg.bands[0] + band_len;
+
+            res = jd_decomp(jd, jpg_out, scale);
+            if (res != JDR_OK && res != JDR_INTR) {
+                jpg_raise(res);
+            }
+        }
+        wait_color(self);
+        nlr_pop();
+    } else {
+        wait_color(self);
+        scratch_put(self, jpg.bands[0]);
+        m_free(self->work);
+        self->work = NULL;
+        if (jpg.file != MP_OBJ_NULL) {
+            mp_file_close(jpg.file);
+        }
+        nlr_jump(nlr.ret_val);
+    }
+
+    scratch_put(self, jpg.bands[0]);
+    m_free(self->work);
+    self->work = NULL;
+    if (jpg.file != MP_OBJ_NULL) {
+        mp_file_close(jpg.file);
+    }
+
+    mp_obj_t result[2] = {
+        mp_obj_new_int(jpg.width),
+        mp_obj_new_int(height),
+    };
+    return mp_obj_new_tuple(2, result);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_jpg_obj, 4, 5, rm67162_RM67162_jpg);
+
+
+STATIC uint16_t blend565(uint16_t fg, uint16_t bg, uint32_t alpha);
+
+
+// Input and output of the PNG decoder in png().
+typedef struct _rm67162_png_t {
+    rm67162_RM67162_obj_t *self;
+    mp_obj_t file;              // MP_OBJ_NULL if decoded from data
+    const uint8_t *data;
+    size_t data_len;
+    int x;                      // of the image on the display
+    int y;
+    int x0;                     // visible columns on the display, x1 exclusive
+    int x1;
+    int last;                   // last visible row on the display
+    uint16_t bg;                // color transparent pixels are blended over
+    const uint16_t *frame;      // or the frame buffer, NULL if bg
+    uint16_t *bands[2];         // rows, one band is filled while the other is sent
+    int band;
+    int band_rows;
+    int rows;                   // in the band being filled
+} rm67162_png_t;
+
+
+STATIC size_t png_in(pngle_t *png, uint8_t *buf, size_t len) {
+    rm67162_png_t *p = png->device;
+    if (p->file != MP_OBJ_NULL) {
+        return mp_file_readinto(p->file, buf, len);
+    }
+    len = MIN(len, p->data_len);
+    memcpy(buf, p->data, len);
+    p->data += len;
+    p->data_len -= len;
+    return len;
+}
+
+
+// Converts the visible columns of a row into the band, which is sent when it
+// is full or the row is the last visible one. Stops the decoder below it.
+STATIC int png_out(pngle_t *png, uint32_t y, const uint8_t *rgba) {
+    rm67162_png_t *p = png->device;
+    rm67162_RM67162_obj_t *self = p->self;
+    int row = p->y + (int)y;
+    if (row < 0) {
+        return 1;
+    }
+
+    int bw = p->x1 - p->x0;
+    uint16_t *out = p->bands[p->band] + p->rows * bw;
+    const uint8_t *px = rgba + (p->x0 - p->x) * 4;
+    for (int col = p->x0; col < p->x1; col++, px += 4) {
+        uint16_t color = colorRGB(px[0], px[1], px[2]);
+        if (px[3] != 0xFF) {
+            uint16_t under = (p->frame) ? p->frame[row * self->width + col] : p->bg;
+            color = (px[3]) ? blend565(color, under, (px[3] * 32 + 127) / 255) : under;
+        }
+        *out++ = color;
+    }
+    if (++p->rows < p->band_rows && row < p->last) {
+        return 1;
+    }
+
+    int y0 = row - p->rows + 1;
+    const uint16_t *band = p->bands[p->band];
+    if (self->use_frame_buffer) {
+        fb_write(self, p->x0, y0, p->x1 - 1, row, band, p->rows * bw);
+    } else if (set_area(self, p->x0 + self->x_gap, y0 + self->y_gap, p->x1 - 1 + self->x_gap, row + self->y_gap)) {
+        // the next rows are decoded into the other band meanwhile
+        write_color_async(self, band, p->rows * bw * 2);
+        p->band ^= 1;
+    }
+    p->rows = 0;
+    return row < p->last;
+}
+
+
+STATIC void png_raise(PNGLE_RESULT res) {
+    switch (res) {
+        case PNGLE_FMT3:
+            mp_raise_ValueError(MP_ERROR_TEXT("unsupported PNG"));
+            break;
+        case PNGLE_INP:
+            mp_raise_ValueError(MP_ERROR_TEXT("not a PNG"));
+            break;
+        default:
+            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("PNG data error"));
+            break;
+    }
+}
+
+
+// png(path_or_buffer, x, y[, bg]) draws a PNG at (x, y), clipped to the
+// display. Transparent pixels are blended over bg, BLACK by default, or over
+// the frame buffer if bg is None. The image is inflated and unfiltered one
+// scanline at a time through scanline_ringbuf, which holds the LZ77 window and
+// two scanlines, and sent RM67162_PNG_ROWS rows at a time from two alternating
+// bands. Interlaced images are not supported. Returns (width, height).
+STATIC mp_obj_t rm67162_RM67162_png(size_t n_args, const mp_obj_t *args) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    rm67162_png_t p;
+    p.self = self;
+    p.x = mp_obj_get_int(args[2]);
+    p.y = mp_obj_get_int(args[3]);
+    p.bg = BLACK;
+    p.frame = NULL;
+    if (n_args > 4 && args[4] == mp_const_none) {
+        if (!self->use_frame_buffer) {
+            mp_raise_ValueError(MP_ERROR_TEXT("bg None requires use_frame_buffer"));
+        }
+        p.frame = fb_acquire(self);
+    } else if (n_args > 4) {
+        p.bg = mp_obj_get_int(args[4]);
+    }
+    p.file = MP_OBJ_NULL;
+    p.bands[0] = NULL;
+    p.band = 0;
+    p.rows = 0;
+    if (mp_obj_is_str(args[1])) {
+        p.file = mp_file_open(mp_obj_str_get_str(args[1]), "rb");
+    } else {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+        p.data = bufinfo.buf;
+        p.data_len = bufinfo.len;
     }
 
-    // Split into steep and not steep for FastH/V separation
-    if (steep) {
-        for (; x0 <= x1; x0++) {
-            dlen++;
-            err -= dy;
-            if (err < 0) {
-                err += dx;
-                fast_vline(self, y0, xs, dlen, color);
-                dlen = 0;
-                y0 += ystep;
-                xs = x0 + 1;
-            }
+    // the decoder state is heap allocated next to the scanlines, the large
+    // slot is left to the bands
+    pngle_t *png = self->work = m_malloc(sizeof(pngle_t));
+    self->scanline_ringbuf = NULL;
+    size_t size;
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        PNGLE_RESULT res = pngle_prepare(png, png_in, &p);
+        if (res != PNGLE_OK) {
+            png_raise(res);
         }
-        if (dlen) {
-            fast_vline(self, y0, xs, dlen, color);
+        p.x0 = MAX(p.x, 0);
+        p.x1 = MIN(p.x + (int)png->width, (int)self->width);
+        p.last = MIN(p.y + (int)png->height, (int)self->height) - 1;
+
+        if (p.x0 < p.x1 && p.y < self->height && p.last >= 0) {
+            self->scanline_ringbuf = m_malloc(png->window_size + 2 * png->line_size + 4 * png->width);
+            png->window = self->scanline_ringbuf;
+            png->lines = png->window + png->window_size;
+            png->rgba = png->lines + 2 * png->line_size;
+
+            size_t band_len = (p.x1 - p.x0) * RM67162_PNG_ROWS;
+            size = 2 * band_len * 2;
+            p.bands[0] = scratch_get(self, 2 * (p.x1 - p.x0) * 2, &size);
+            p.band_rows = size / (2 * (p.x1 - p.x0) * 2);
+            p.bands[1] = p.bands[0] + p.band_rows * (p.x1 - p.x0);
+
+            res = pngle_decode(png, png_out);
+            if (res != PNGLE_OK && res != PNGLE_INTR) {
+                png_raise(res);
+            }
         }
+        wait_color(self);
+        nlr_pop();
     } else {
-        for (; x0 <= x1; x0++) {
-            dlen++;
-            err -= dy;
-            if (err < 0) {
-                err += dx;
-                fast_hline(self, xs, y0, dlen, color);
-                dlen = 0;
-                y0 += ystep;
-                xs = x0 + 1;
-            }
+        wait_color(self);
+        scratch_put(self, p.bands[0]);
+        m_free(self->work);
+        self->work = NULL;
+        m_free(self->scanline_ringbuf);
+        self->scanline_ringbuf = NULL;
+        if (p.file != MP_OBJ_NULL) {
+            mp_file_close(p.file);
         }
-        if (dlen) {
-            fast_hline(self, xs, y0, dlen, color);
+        nlr_jump(nlr.ret_val);
+    }
+
+    mp_obj_t result[2] = {
+        mp_obj_new_int(png->width),
+        mp_obj_new_int(png->height),
+    };
+    scratch_put(self, p.bands[0]);
+    m_free(self->work);
+    self->work = NULL;
+    m_free(self->scanline_ringbuf);
+    self->scanline_ringbuf = NULL;
+    if (p.file != MP_OBJ_NULL) {
+        mp_file_close(p.file);
+    }
+    return mp_obj_new_tuple(2, result);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_png_obj, 4, 5, rm67162_RM67162_png);
+
+
+// Double buffered show(). The drawn buffer becomes the front buffer and the
+// rows holding dirty tiles are sent from it in one background transfer, while
+// drawing goes on in the other buffer. That one still holds the frame before,
+// so the dirty rectangles are copied over to keep it current.
+STATIC void show_swap(rm67162_RM67162_obj_t *self) {
+    rm67162_rect_t rects[RM67162_MAX_DIRTY];
+    int n = dirty_rects(self, rects);
+    if (n == 0) {
+        return;
+    }
+    int y0 = self->height;
+    int y1 = 0;
+    for (int i = 0; i < n; i++) {
+        y0 = MIN(y0, rects[i].y);
+        y1 = MAX(y1, rects[i].y + rects[i].h - 1);
+    }
+
+    uint16_t *front = self->frame_buffer;
+    self->frame_buffer = self->front_buffer;
+    self->front_buffer = front;
+
+    if (set_area(self, 0, y0, self->max_width_value, y1)) {
+        write_color_async(self, front + y0 * self->width, (y1 - y0 + 1) * self->width * 2);
+    }
+    for (int i = 0; i < n; i++) {
+        for (int y = rects[i].y; y < rects[i].y + rects[i].h; y++) {
+            size_t offset = y * self->width + rects[i].x;
+            memcpy(self->frame_buffer + offset, front + offset, rects[i].w * 2);
         }
     }
+    self->stat_dirty_bytes += (y1 - y0 + 1) * self->width * 2;
+    self->stat_rects++;
 }
 
 
-STATIC mp_obj_t rm67162_RM67162_line(size_t n_args, const mp_obj_t *args_in) {
+// Sends the dirty parts of the frame buffer, or all of it if full is True. The
+// last full width rectangle is still transferred when this returns, the next
+// drawing call waits for it.
+STATIC mp_obj_t rm67162_RM67162_show(size_t n_args, const mp_obj_t *args_in) {
     rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
-    uint16_t x0 = mp_obj_get_int(args_in[1]);
-    uint16_t y0 = mp_obj_get_int(args_in[2]);
-    uint16_t x1 = mp_obj_get_int(args_in[3]);
-    uint16_t y1 = mp_obj_get_int(args_in[4]);
-    uint16_t color = mp_obj_get_int(args_in[5]);
 
-    line(self, x0, y0, x1, y1, color);
+    if (!self->use_frame_buffer || self->frame_buffer == NULL) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No framebuffer available."));
+    }
+    if (n_args > 1 && mp_obj_is_true(args_in[1])) {
+        dirty_mark_all(self);
+        self->shadow_valid = false;
+    }
+    // the front buffer is about to be drawn into
+    wait_color(self);
+    pace_frame(self);
+    wait_te(self);
+
+    if (self->front_buffer) {
+        show_swap(self);
+        dirty_clear(self);
+        self->stat_shows++;
+        return mp_const_none;
+    }
+    if (self->shadow_buffer && self->shadow_valid) {
+        show_diff(self);
+        dirty_clear(self);
+        self->stat_shows++;
+        return mp_const_none;
+    }
+    if (self->shadow_buffer) {
+        dirty_mark_all(self);
+    }
+
+    rm67162_rect_t rects[RM67162_MAX_DIRTY];
+    int n = dirty_rects(self, rects);
+    for (int i = 0; i < n; i++) {
+        fb_flush_rect(self, &rects[i]);
+        self->stat_dirty_bytes += rects[i].w * rects[i].h * 2;
+    }
+    dirty_clear(self);
+    self->stat_shows++;
+    self->stat_rects += n;
+
+    // the first frame is sent in full, it is the reference for show_diff()
+    if (self->shadow_buffer) {
+        memcpy(self->shadow_buffer, self->frame_buffer, self->frame_buffer_size);
+        self->shadow_valid = true;
+    }
+
     return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_line_obj, 6, 6, rm67162_RM67162_line);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_show_obj, 1, 2, rm67162_RM67162_show);
 
 
-// Return the center of a polygon as an (x, y) tuple
-STATIC mp_obj_t rm67162_RM67162_polygon_center(size_t n_args, const mp_obj_t *args) {
-    size_t poly_len;
-    mp_obj_t *polygon;
-    mp_obj_get_array(args[1], &poly_len, &polygon);
+// The frame buffer as a bytearray, e.g. for framebuf.FrameBuffer. Writes through
+// it are not tracked as dirty, use show(True) or frame_diff. Double buffered
+// it is a different buffer after every show().
+STATIC mp_obj_t rm67162_RM67162_frame_buffer(mp_obj_t self_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
-    mp_float_t sum = 0.0;
-    int vsx = 0;
-    int vsy = 0;
+    return mp_obj_new_bytearray_by_ref(self->frame_buffer_size, fb_acquire(self));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_frame_buffer_obj, rm67162_RM67162_frame_buffer);
 
-    if (poly_len > 0) {
-        for (int idx = 0; idx < poly_len; idx++) {
-            size_t point_from_poly_len;
-            mp_obj_t *point_from_poly;
-            mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
-            if (point_from_poly_len < 2) {
-                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-            }
 
-            mp_int_t v1x = mp_obj_get_int(point_from_poly[0]);
-            mp_int_t v1y = mp_obj_get_int(point_from_poly[1]);
+// The rectangles the next show() would send.
+STATIC mp_obj_t rm67162_RM67162_dirty_rects(mp_obj_t self_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
-            mp_obj_get_array(polygon[(idx + 1) % poly_len], &point_from_poly_len, &point_from_poly);
-            if (point_from_poly_len < 2) {
-                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-            }
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    if (self->dirty_tiles == NULL) {
+        return list;
+    }
+    rm67162_rect_t rects[RM67162_MAX_DIRTY];
+    int n = dirty_rects(self, rects);
+    for (int i = 0; i < n; i++) {
+        mp_obj_t rect[4] = {
+            mp_obj_new_int(rects[i].x),
+            mp_obj_new_int(rects[i].y),
+            mp_obj_new_int(rects[i].w),
+            mp_obj_new_int(rects[i].h),
+        };
+        mp_obj_list_append(list, mp_obj_new_tuple(4, rect));
+    }
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_dirty_rects_obj, rm67162_RM67162_dirty_rects);
 
-            mp_int_t v2x = mp_obj_get_int(point_from_poly[0]);
-            mp_int_t v2y = mp_obj_get_int(point_from_poly[1]);
 
-            mp_float_t cross = v1x * v2y - v1y * v2x;
-            sum += cross;
-            vsx += (int)((v1x + v2x) * cross);
-            vsy += (int)((v1y + v2y) * cross);
-        }
+STATIC mp_obj_t rm67162_RM67162_stats(mp_obj_t self_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
 
-        mp_float_t z = 1.0 / (3.0 * sum);
-        vsx = (int)(vsx * z);
-        vsy = (int)(vsy * z);
-    } else {
-        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-    }
+    mp_obj_t dict = mp_obj_new_dict(0);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_shows), mp_obj_new_int_from_uint(self->stat_shows));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_rects), mp_obj_new_int_from_uint(self->stat_rects));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_dirty_bytes), mp_obj_new_int_from_uint(self->stat_dirty_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_skipped_bytes), mp_obj_new_int_from_uint(self->stat_skipped_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_missed), mp_obj_new_int_from_uint(self->stat_missed));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_allocs), mp_obj_new_int_from_uint(self->stat_allocs));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_glyph_hits), mp_obj_new_int_from_uint(self->stat_glyph_hits));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_glyph_misses), mp_obj_new_int_from_uint(self->stat_glyph_misses));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_stats_obj, rm67162_RM67162_stats);
 
-    mp_obj_t center[2] = {mp_obj_new_int(vsx), mp_obj_new_int(vsy)};
-    return mp_obj_new_tuple(2, center);
+
+STATIC mp_obj_t rm67162_RM67162_reset_stats(mp_obj_t self_in) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    self->stat_shows = 0;
+    self->stat_rects = 0;
+    self->stat_dirty_bytes = 0;
+    self->stat_skipped_bytes = 0;
+    self->stat_missed = 0;
+    self->stat_allocs = 0;
+    self->stat_glyph_hits = 0;
+    self->stat_glyph_misses = 0;
+    return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_polygon_center_obj, 2, 2, rm67162_RM67162_polygon_center);
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_reset_stats_obj, rm67162_RM67162_reset_stats);
 
 
-static void RotatePolygon(Polygon *polygon, Point center, mp_float_t angle) {
-    if (polygon->length == 0) {
-        return;         /* reject null polygons */
+STATIC mp_obj_t rm67162_RM67162_text(size_t n_args, const mp_obj_t *args) {
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    uint8_t single_char_s;
+    const uint8_t *source = NULL;
+    size_t source_len = 0;
 
+    // extract arguments, a Font converted from a text() font is drawn by write()
+    if (mp_obj_is_type(args[1], &rm67162_font_type)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("text() takes a font module, use write() for a Font"));
     }
-    mp_float_t cosAngle = MICROPY_FLOAT_C_FUN(cos)(angle);
-    mp_float_t sinAngle = MICROPY_FLOAT_C_FUN(sin)(angle);
-
-    for (int i = 0; i < polygon->length; i++) {
-        mp_float_t dx = (polygon->points[i].x - center.x);
-        mp_float_t dy = (polygon->points[i].y - center.y);
+    mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);
 
-        polygon->points[i].x = center.x + (int)0.5 + (dx * cosAngle - dy * sinAngle);
-        polygon->points[i].y = center.y + (int)0.5 + (dx * sinAngle + dy * cosAngle);
+    if (mp_obj_is_int(args[2])) {
+        mp_int_t c = mp_obj_get_int(args[2]);
+        single_char_s = (c & 0xff);
+        source = &single_char_s;
+        source_len = 1;
+    } else if (mp_obj_is_str(args[2])) {
+        source = (uint8_t *) mp_obj_str_get_str(args[2]);
+        source_len = strlen((char *)source);
+    } else if (mp_obj_is_type(args[2], &mp_type_bytes)) {
+        mp_obj_t text_data_buff = args[2];
+        mp_buffer_info_t text_bufinfo;
+        mp_get_buffer_raise(text_data_buff, &text_bufinfo, MP_BUFFER_READ);
+        source = text_bufinfo.buf;
+        source_len = text_bufinfo.len;
+    } else {
+        mp_raise_TypeError(MP_ERROR_TEXT("text requires either int, str or bytes."));
+        return mp_const_none;
     }
-}
 
-//
-// public-domain code by Darel Rex Finley, 2007
-// https://alienryderflex.com/polygon_fill/
-//
+    mp_int_t x0 = mp_obj_get_int(args[3]);
+    mp_int_t y0 = mp_obj_get_int(args[4]);
 
-#define MAX_POLY_CORNERS 32
-STATIC void PolygonFill(rm67162_RM67162_obj_t *self, Polygon *polygon, Point location, uint16_t color) {
-    int nodes, nodeX[MAX_POLY_CORNERS], pixelY, i, j, swap;
+    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(font->globals);
+    const uint8_t width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTH)));
+    const uint8_t height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
+    const uint8_t first = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FIRST)));
+    const uint8_t last = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_LAST)));
 
-    int minX = INT_MAX;
-    int maxX = INT_MIN;
-    int minY = INT_MAX;
-    int maxY = INT_MIN;
+    mp_obj_t font_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FONT));
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(font_data_buff, &bufinfo, MP_BUFFER_READ);
+    const uint8_t *font_data = bufinfo.buf;
 
-    for (i = 0; i < polygon->length; i++) {
-        if (polygon->points[i].x < minX) {
-            minX = (int)polygon->points[i].x;
-        }
+    uint16_t fg_color;
+    uint16_t bg_color;
 
-        if (polygon->points[i].x > maxX) {
-            maxX = (int)polygon->points[i].x;
-        }
+    if (n_args > 5) {
+        fg_color = mp_obj_get_int(args[5]);
+    } else {
+        fg_color = WHITE;
+    }
+
+    if (n_args > 6) {
+        bg_color = mp_obj_get_int(args[6]);
+    } else {
+        bg_color = BLACK;
+    }
+
+    uint8_t wide = width / 8;
 
-        if (polygon->points[i].y < minY) {
-            minY = (int)polygon->points[i].y;
+    // characters outside the font are skipped
+    size_t count = 0;
+    for (size_t i = 0; i < source_len; i++) {
+        if (source[i] >= first && source[i] <= last) {
+            count++;
         }
+    }
+
+    // the whole string is one window, clipped to the display
+    int x_start = MAX(x0, 0);
+    int x_end = MIN(x0 + (int)(count * width), (int)self->width);
+    int y_start = MAX(y0, 0);
+    int y_end = MIN(y0 + height, (int)self->height);
+    if (x_start >= x_end || y_start >= y_end) {
+        return mp_const_none;
+    }
 
-        if (polygon->points[i].y > maxY) {
-            maxY = (int)polygon->points[i].y;
+    // rendered in bands of as many rows as the buffer holds
+    int w = x_end - x_start;
+    size_t buf_size = w * (y_end - y_start) * 2;
+    uint16_t *buffer = scratch_get(self, w * 2, &buf_size);
+    int band_rows = buf_size / (w * 2);
+
+    // the cached glyphs of the visible characters, NULL to expand the bits,
+    // volatile as it is assigned under nlr_push()
+    const uint16_t **volatile cached = NULL;
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        if (cached) {
+            scratch_put(self, (void *)cached);
         }
+        scratch_put(self, buffer);
+        nlr_jump(nlr.ret_val);
     }
 
-    //  Loop through the rows
-    for (pixelY = minY; pixelY < maxY; pixelY++) {
-        //  Build a list of nodes.
-        nodes = 0;
-        j = polygon->length - 1;
-        for (i = 0; i < polygon->length; i++) {
-            if ((polygon->points[i].y < pixelY && polygon->points[j].y >= pixelY) ||
-                (polygon->points[j].y < pixelY && polygon->points[i].y >= pixelY)) {
-                if (nodes < MAX_POLY_CORNERS) {
-                    nodeX[nodes++] = (int)(polygon->points[i].x +
-                        (pixelY - polygon->points[i].y) /
-                        (polygon->points[j].y - polygon->points[i].y) *
-                        (polygon->points[j].x - polygon->points[i].x));
-                } else {
-                    mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon too complex increase MAX_POLY_CORNERS."));
-                }
+    if (self->glyphs) {
+        glyph_cache_begin(self);
+        size_t cached_size = count * sizeof(uint16_t *);
+        cached = scratch_get(self, cached_size, &cached_size);
+        int x = x0;
+        for (size_t i = 0, n = 0; i < source_len; i++) {
+            uint8_t chr = source[i];
+            if (chr < first || chr > last) {
+                continue;
             }
-            j = i;
-        }
-
-        //  Sort the nodes, via a simple “Bubble” sort.
-        i = 0;
-        while (i < nodes - 1) {
-            if (nodeX[i] > nodeX[i + 1]) {
-                swap = nodeX[i];
-                nodeX[i] = nodeX[i + 1];
-                nodeX[i + 1] = swap;
-                if (i) {
-                    i--;
+            const uint16_t *pixels = NULL;
+            if (x + width > x_start && x < x_end) {
+                pixels = glyph_cache_find(self, args[1], chr, fg_color, bg_color);
+                if (pixels == NULL) {
+                    uint16_t *p = glyph_cache_add(self, args[1], chr, fg_color, bg_color, width, height);
+                    const uint8_t *bits = font_data + (chr - first) * height * wide;
+                    for (int idx = 0; p && idx < width * height; idx++) {
+                        int bx = idx % width;
+                        p[idx] = (bits[(idx / width) * wide + (bx >> 3)] & (0x80 >> (bx & 7))) ? fg_color : bg_color;
+                    }
+                    pixels = p;
                 }
-            } else {
-                i++;
             }
+            cached[n++] = pixels;
+            x += width;
         }
+    }
 
-        //  Fill the pixels between node pairs.
-        for (i = 0; i < nodes; i += 2) {
-            if (nodeX[i] >= maxX) {
-                break;
-            }
-
-            if (nodeX[i + 1] > minX) {
-                if (nodeX[i] < minX) {
-                    nodeX[i] = minX;
+    for (int y = y_start; y < y_end; y += band_rows) {
+        int rows = MIN(band_rows, y_end - y);
+        for (int row = 0; row < rows; row++) {
+            uint16_t *out = buffer + row * w;
+            int line = y + row - y0;
+            int x = x0;
+
+            for (size_t i = 0, n = 0; i < source_len && x < x_end; i++) {
+                uint8_t chr = source[i];
+                if (chr < first || chr > last) {
+                    continue;
                 }
-
-                if (nodeX[i + 1] > maxX) {
-                    nodeX[i + 1] = maxX;
+                int bx0 = MAX(x_start - x, 0);
+                int bx1 = MIN(x_end - x, (int)width);
+                if (cached && cached[n]) {
+                    memcpy(out + x + bx0 - x_start, cached[n] + line * width + bx0, (bx1 - bx0) * 2);
+                } else {
+                    const uint8_t *bits = font_data + ((chr - first) * height + line) * wide;
+                    for (int bx = bx0; bx < bx1; bx++) {
+                        out[x + bx - x_start] = (bits[bx >> 3] & (0x80 >> (bx & 7))) ? fg_color : bg_color;
+                    }
                 }
-
-                fast_hline(self, (int)location.x + nodeX[i], (int)location.y + pixelY, nodeX[i + 1] - nodeX[i] + 1, color);
+                x += width;
+                n++;
             }
         }
+        blit_buffer(self, x_start, y, w, rows, buffer);
     }
-}
-
-
-STATIC mp_obj_t rm67162_RM67162_polygon(size_t n_args, const mp_obj_t *args) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-
-    size_t poly_len;
-    mp_obj_t *polygon;
-    mp_obj_get_array(args[1], &poly_len, &polygon);
-
-    self->work = NULL;
-
-    if (poly_len > 0) {
-        mp_int_t x = mp_obj_get_int(args[2]);
-        mp_int_t y = mp_obj_get_int(args[3]);
-        mp_int_t color = mp_obj_get_int(args[4]);
 
-        mp_float_t angle = 0.0f;
-        if (n_args > 5 && mp_obj_is_float(args[5])) {
-            angle = mp_obj_float_get(args[5]);
-        }
-
-        mp_int_t cx = 0;
-        mp_int_t cy = 0;
-
-        if (n_args > 6) {
-            cx = mp_obj_get_int(args[6]);
-            cy = mp_obj_get_int(args[7]);
-        }
+    nlr_pop();
+    if (cached) {
+        scratch_put(self, (void *)cached);
+    }
+    scratch_put(self, buffer);
 
-        self->work = m_malloc(poly_len * sizeof(Point));
-        if (self->work) {
-            Point *point = (Point *)self->work;
+    return mp_const_none;
+}
 
-            for (int idx = 0; idx < poly_len; idx++) {
-                size_t point_from_poly_len;
-                mp_obj_t *point_from_poly;
-                mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
-                if (point_from_poly_len < 2) {
-                    mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-                }
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_text_obj, 5, 7, rm67162_RM67162_text);
 
-                mp_int_t px = mp_obj_get_int(point_from_poly[0]);
-                mp_int_t py = mp_obj_get_int(point_from_poly[1]);
-                point[idx].x = px;
-                point[idx].y = py;
-            }
+// Read position in the BITMAPS of a write() font, glyphs start at any bit.
+typedef struct _rm67162_bits_t {
+    const uint8_t *data;
+    const uint8_t *end;
+    uint32_t bit;
+} rm67162_bits_t;
+
+
+// The next 32 bits of the stream, the first one in the most significant bit.
+// Bytes past the end read as 0.
+STATIC uint32_t bits_peek(const rm67162_bits_t *bits) {
+    const uint8_t *p = bits->data + (bits->bit >> 3);
+    uint64_t word = 0;
+    for (int i = 0; i < 5; i++) {
+        word = (word << 8) | ((p + i < bits->end) ? p[i] : 0);
+    }
+    return (uint32_t)(word >> (8 - (bits->bit & 7)));
+}
 
-            Point center;
-            center.x = cx;
-            center.y = cy;
 
-            Polygon polygon;
-            polygon.length = poly_len;
-            polygon.points = self->work;
+// The next pixel value of bpp bits.
+STATIC uint8_t bits_get(rm67162_bits_t *bits, uint8_t bpp) {
+    uint8_t value = bits_peek(bits) >> (32 - bpp);
+    bits->bit += bpp;
+    return value;
+}
 
-            if (angle > 0) {
-                RotatePolygon(&polygon, center, angle);
-            }
 
-            for (int idx = 1; idx < poly_len; idx++) {
-                line(
-                    self,
-                    (int)point[idx - 1].x + x,
-                    (int)point[idx - 1].y + y,
-                    (int)point[idx].x + x,
-                    (int)point[idx].y + y, color);
+// Unpacks n pixel to their colors in lut, 32 bits at a time. Inlined with a
+// constant bpp for each of the kernels below.
+static inline void bits_unpack_n(rm67162_bits_t *bits, const int bpp, int n, uint16_t *out, const uint16_t *lut) {
+    while (n > 0) {
+        uint32_t word = bits_peek(bits);
+        int take = MIN(n, 32 / bpp);
+        bits->bit += take * bpp;
+        n -= take;
+
+        // runs of background are common, and of foreground at 1 bpp
+        if (word == 0 || (bpp == 1 && word == 0xFFFFFFFF)) {
+            uint16_t color = lut[word & 1];
+            while (take--) {
+                *out++ = color;
             }
-
-            m_free(self->work);
-            self->work = NULL;
-        } else {
-            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            continue;
+        }
+        while (take--) {
+            *out++ = lut[word >> (32 - bpp)];
+            word <<= bpp;
         }
-    } else {
-        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
     }
-
-    return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_polygon_obj, 4, 8, rm67162_RM67162_polygon);
 
 
-STATIC mp_obj_t rm67162_RM67162_fill_polygon(size_t n_args, const mp_obj_t *args) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+STATIC void bits_unpack(rm67162_bits_t *bits, uint8_t bpp, int n, uint16_t *out, const uint16_t *lut) {
+    switch (bpp) {
+        case 1:
+            bits_unpack_n(bits, 1, n, out, lut);
+            break;
+        case 2:
+            bits_unpack_n(bits, 2, n, out, lut);
+            break;
+        case 4:
+            bits_unpack_n(bits, 4, n, out, lut);
+            break;
+        default:
+            while (n--) {
+                *out++ = lut[bits_get(bits, bpp)];
+            }
+            break;
+    }
+}
 
-    size_t poly_len;
-    mp_obj_t *polygon;
-    mp_obj_get_array(args[1], &poly_len, &polygon);
 
-    self->work = NULL;
+// Blends fg over bg by alpha out of 32. The colors are in the byte order
+// sent to the panel, the channels are spread apart in a word so that they
+// are blended with one multiplication.
+STATIC uint16_t blend565(uint16_t fg, uint16_t bg, uint32_t alpha) {
+    uint32_t f = _swap_bytes(fg);
+    uint32_t b = _swap_bytes(bg);
+    f = (f | f << 16) & 0x07E0F81F;
+    b = (b | b << 16) & 0x07E0F81F;
+    b = ((((f - b) * alpha) >> 5) + b) & 0x07E0F81F;
+    return _swap_bytes((b | b >> 16) & 0xFFFF);
+}
 
-    if (poly_len > 0) {
-        mp_int_t x = mp_obj_get_int(args[2]);
-        mp_int_t y = mp_obj_get_int(args[3]);
-        mp_int_t color = mp_obj_get_int(args[4]);
 
-        mp_float_t angle = 0.0f;
-        if (n_args > 5) {
-            angle = mp_obj_float_get(args[5]);
-        }
+// Coverage of a pixel value of bpp bits, out of 32.
+STATIC uint32_t coverage(uint8_t value, uint8_t bpp) {
+    uint32_t max = (1 << bpp) - 1;
+    return (value * 32 + max / 2) / max;
+}
 
-        mp_int_t cx = 0;
-        mp_int_t cy = 0;
 
-        if (n_args > 6) {
-            cx = mp_obj_get_int(args[6]);
-            cy = mp_obj_get_int(args[7]);
-        }
+// The colors of all 1 << bpp pixel values, fg blended over bg by coverage.
+STATIC void blend_lut(uint16_t *lut, uint8_t bpp, uint16_t fg, uint16_t bg) {
+    for (int v = 0; v < (1 << bpp); v++) {
+        lut[v] = blend565(fg, bg, coverage(v, bpp));
+    }
+}
 
-        self->work = m_malloc(poly_len * sizeof(Point));
-        if (self->work) {
-            Point *point = (Point *)self->work;
 
-            for (int idx = 0; idx < poly_len; idx++) {
-                size_t point_from_poly_len;
-                mp_obj_t *point_from_poly;
-                mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
-                if (point_from_poly_len < 2) {
-                    mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-                }
+STATIC int code_compare(const void *a, const void *b) {
+    const rm67162_code_t *ca = a;
+    const rm67162_code_t *cb = b;
+    if (ca->code != cb->code) {
+        return (ca->code < cb->code) ? -1 : 1;
+    }
+    return (int)ca->index - (int)cb->index;
+}
 
-                point[idx].x = mp_obj_get_int(point_from_poly[0]);
-                point[idx].y = mp_obj_get_int(point_from_poly[1]);
-            }
 
-            Point center = {cx, cy};
-            Polygon polygon = {poly_len, self->work};
+// The glyph index of a write() font MAP, built on first use and kept for the
+// last RM67162_FONT_INDEXES fonts.
+STATIC const rm67162_font_index_t *font_index_get(rm67162_RM67162_obj_t *self, mp_obj_t map_obj) {
+    for (int i = 0; i < RM67162_FONT_INDEXES; i++) {
+        if (self->font_index[i].map == map_obj) {
+            return &self->font_index[i];
+        }
+    }
+
+    GET_STR_DATA_LEN(map_obj, map_data, map_len);
+    const byte *s = map_data, *top = map_data + map_len;
+    size_t count = 0;
+    while (s < top) {
+        s = utf8_next_char(s);
+        count++;
+    }
 
-            if (angle != 0) {
-                RotatePolygon(&polygon, center, angle);
-            }
+    rm67162_code_t *codes = m_new(rm67162_code_t, count);
+    s = map_data;
+    for (size_t i = 0; i < count; i++) {
+        codes[i].code = utf8_get_char(s);
+        codes[i].index = i;
+        s = utf8_next_char(s);
+    }
+    // the first of equal characters is found, as with a scan of the MAP
+    qsort(codes, count, sizeof(rm67162_code_t), code_compare);
+
+    rm67162_font_index_t *index = &self->font_index[self->font_index_next];
+    self->font_index_next = (self->font_index_next + 1) % RM67162_FONT_INDEXES;
+    m_free(index->codes);
+    index->map = map_obj;
+    index->codes = codes;
+    index->count = count;
+    return index;
+}
 
-            Point location = {x, y};
-            PolygonFill(self, &polygon, location, color);
 
-            m_free(self->work);
-            self->work = NULL;
+// The glyph of ch by binary search, -1 if the font has none.
+STATIC int font_index_find(const rm67162_font_index_t *index, unichar ch) {
+    size_t lo = 0;
+    size_t hi = index->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (index->codes[mid].code < ch) {
+            lo = mid + 1;
         } else {
-            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            hi = mid;
         }
+    }
+    return (lo < index->count && index->codes[lo].code == ch) ? (int)index->codes[lo].index : -1;
+}
 
+
+// Read position in a run-length encoded glyph of a Font. At 1 bpp a run is a
+// byte of the value in bit 7 and the length - 1 in bits 0-6, otherwise a byte
+// of the length - 1 followed by a byte of the value. Runs cross rows.
+typedef struct _rm67162_runs_t {
+    const uint8_t *data;
+    const uint8_t *end;
+    uint16_t left;              // pixels left of the current run
+    uint8_t value;
+    uint8_t bpp;
+} rm67162_runs_t;
+
+
+// Starts the next run, past the end of the glyph pixels are 0.
+STATIC void runs_next(rm67162_runs_t *runs) {
+    if (runs->data >= runs->end) {
+        runs->value = 0;
+        runs->left = UINT16_MAX;
+    } else if (runs->bpp == 1) {
+        runs->value = *runs->data >> 7;
+        runs->left = (*runs->data++ & 0x7F) + 1;
     } else {
-        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+        // masked, only the first 1 << bpp entries of the lut are set
+        runs->left = *runs->data++ + 1;
+        runs->value = (runs->data < runs->end) ? *runs->data++ & ((1 << runs->bpp) - 1) : 0;
     }
+}
 
-    return mp_const_none;
+
+// The next pixel value.
+STATIC uint8_t runs_get(rm67162_runs_t *runs) {
+    if (runs->left == 0) {
+        runs_next(runs);
+    }
+    runs->left--;
+    return runs->value;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_fill_polygon_obj, 4, 8, rm67162_RM67162_fill_polygon);
 
 
-STATIC mp_obj_t rm67162_RM67162_bitmap(size_t n_args, const mp_obj_t *args_in) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+// Fills n pixel with the colors in lut of the runs, a run at a time.
+STATIC void runs_unpack(rm67162_runs_t *runs, int n, uint16_t *out, const uint16_t *lut) {
+    while (n > 0) {
+        if (runs->left == 0) {
+            runs_next(runs);
+        }
+        int take = MIN(n, runs->left);
+        uint16_t color = lut[runs->value];
+        runs->left -= take;
+        n -= take;
+        while (take--) {
+            *out++ = color;
+        }
+    }
+}
 
-    int x_start = mp_obj_get_int(args_in[1]);
-    int y_start = mp_obj_get_int(args_in[2]);
-    int x_end   = mp_obj_get_int(args_in[3]);
-    int y_end   = mp_obj_get_int(args_in[4]);
 
-    x_start += self->x_gap;
-    x_end += self->x_gap;
-    y_start += self->y_gap;
-    y_end += self->y_gap;
+// A write() font, either a font module or a Font, see font_get().
+typedef struct _rm67162_font_t {
+    rm67162_font_obj_t *bin;            // NULL for a font module
+    const rm67162_font_index_t *index;  // the rest is of a font module
+    const uint8_t *widths;
+    const uint8_t *offsets;
+    const uint8_t *bitmaps;
+    size_t bitmaps_len;
+    uint8_t offset_width;
+    uint8_t bpp;
+    uint8_t height;
+    uint8_t max_width;
+} rm67162_font_t;
 
-    mp_buffer_info_t bufinfo;
-    mp_get_buffer_raise(args_in[5], &bufinfo, MP_BUFFER_READ);
-    set_area(self, x_start, y_start, x_end, y_end);
-    size_t len = ((x_end - x_start) * (y_end - y_start) * self->fb_bpp / 8);
-    write_color(self, bufinfo.buf, len);
 
-    return mp_const_none;
+STATIC const uint8_t *font_module_buffer(mp_obj_dict_t *dict, qstr name, size_t *len) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(name)), &bufinfo, MP_BUFFER_READ);
+    if (len) {
+        *len = bufinfo.len;
+    }
+    return bufinfo.buf;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_bitmap_obj, 6, 6, rm67162_RM67162_bitmap);
 
 
-STATIC mp_obj_t rm67162_RM67162_text(size_t n_args, const mp_obj_t *args) {
-    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    uint8_t single_char_s;
-    const uint8_t *source = NULL;
-    size_t source_len = 0;
+// Looks up the font module or Font font_in once per call.
+STATIC void font_get(rm67162_RM67162_obj_t *self, mp_obj_t font_in, rm67162_font_t *font) {
+    if (mp_obj_is_type(font_in, &rm67162_font_type)) {
+        font->bin = MP_OBJ_TO_PTR(font_in);
+        font->bpp = font->bin->bpp;
+        font->height = font->bin->height;
+        font->max_width = font->bin->max_width;
+        return;
+    }
 
-    // extract arguments
-    mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);
+    mp_obj_module_t *module = MP_OBJ_TO_PTR(font_in);
+    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(module->globals);
+    font->bin = NULL;
+    font->bpp = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BPP)));
+    font->height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
+    font->offset_width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_OFFSET_WIDTH)));
+    font->max_width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_MAX_WIDTH)));
+    font->widths = font_module_buffer(dict, MP_QSTR_WIDTHS, NULL);
+    font->offsets = font_module_buffer(dict, MP_QSTR_OFFSETS, NULL);
+    font->bitmaps = font_module_buffer(dict, MP_QSTR_BITMAPS, &font->bitmaps_len);
+    font->index = font_index_get(self, mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_MAP)));
+}
 
-    if (mp_obj_is_int(args[2])) {
-        mp_int_t c = mp_obj_get_int(args[2]);
-        single_char_s = (c & 0xff);
-        source = &single_char_s;
-        source_len = 1;
-    } else if (mp_obj_is_str(args[2])) {
-        source = (uint8_t *) mp_obj_str_get_str(args[2]);
-        source_len = strlen((char *)source);
-    } else if (mp_obj_is_type(args[2], &mp_type_bytes)) {
-        mp_obj_t text_data_buff = args[2];
-        mp_buffer_info_t text_bufinfo;
-        mp_get_buffer_raise(text_data_buff, &text_bufinfo, MP_BUFFER_READ);
-        source = text_bufinfo.buf;
-        source_len = text_bufinfo.len;
-    } else {
-        mp_raise_TypeError(MP_ERROR_TEXT("text requires either int, str or bytes."));
-        return mp_const_none;
-    }
 
-    mp_int_t x0 = mp_obj_get_int(args[3]);
-    mp_int_t y0 = mp_obj_get_int(args[4]);
+// Little-endian fields of a Font.
+STATIC uint32_t font_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
 
-    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(font->globals);
-    const uint8_t width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTH)));
-    const uint8_t height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
-    const uint8_t first = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FIRST)));
-    const uint8_t last = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_LAST)));
 
-    mp_obj_t font_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FONT));
-    mp_buffer_info_t bufinfo;
-    mp_get_buffer_raise(font_data_buff, &bufinfo, MP_BUFFER_READ);
-    const uint8_t *font_data = bufinfo.buf;
+STATIC uint16_t font_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
 
-    uint16_t fg_color;
-    uint16_t bg_color;
 
-    if (n_args > 5) {
-        fg_color = mp_obj_get_int(args[5]);
-    } else {
-        fg_color = WHITE;
+// The glyph of ch and its width, -1 if the font has none.
+STATIC int font_find(const rm67162_font_t *font, unichar ch, uint8_t *width) {
+    if (font->bin == NULL) {
+        int glyph = font_index_find(font->index, ch);
+        if (glyph >= 0) {
+            *width = font->widths[glyph];
+        }
+        return glyph;
     }
 
-    if (n_args > 6) {
-        bg_color = mp_obj_get_int(args[6]);
-    } else {
-        bg_color = BLACK;
+    const uint8_t *index = font->bin->index;
+    size_t lo = 0;
+    size_t hi = font->bin->glyph_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (font_u32(index + mid * RM67162_FONT_ENTRY) < ch) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    const uint8_t *entry = index + lo * RM67162_FONT_ENTRY;
+    if (lo == font->bin->glyph_count || font_u32(entry) != ch) {
+        return -1;
     }
+    *width = entry[8];
+    return lo;
+}
 
-    uint8_t wide = width / 8;
-    size_t buf_size = width * height * 2;
 
-    if (self->use_frame_buffer) {
-    } else {
-        self->frame_buffer = m_malloc(buf_size);
-    }
-
-    uint8_t chr;
-    if (self->frame_buffer) {
-    while (source_len--) {
-        chr = *source++;
-            if (chr >= first && chr <= last) {
-                uint16_t buf_idx = 0;
-                uint16_t chr_idx = (chr - first) * (height * wide);
-                for (uint8_t line = 0; line < height; line++) {
-                    for (uint8_t line_byte = 0; line_byte < wide; line_byte++) {
-                        uint8_t chr_data = font_data[chr_idx];
-                        for (uint8_t bit = 8; bit; bit--) {
-                            if (chr_data >> (bit - 1) & 1) {
-                                self->frame_buffer[buf_idx] = fg_color;
-                            } else {
-                                self->frame_buffer[buf_idx] = bg_color;
-                            }
-                            buf_idx++;
-                        }
-                        chr_idx++;
-                    }
-                }
-                uint16_t x1 = x0 + width - 1;
-                if (x1 < self->width) {
-                    set_area(self, x0, y0, x1, y0 + height - 1);
-                    write_color(self, (uint8_t *)self->frame_buffer, buf_size);
-                }
-                x0 += width;
-            }
+// Sets bits to the start of a glyph. The glyphs of a Font start on a byte,
+// from file they are read into its glyph buffer. Returns true if the glyph
+// is run-length encoded.
+STATIC bool font_bits(const rm67162_font_t *font, int glyph, rm67162_bits_t *bits) {
+    bits->bit = 0;
+    if (font->bin == NULL) {
+        const uint8_t *offset = font->offsets + glyph * font->offset_width;
+        for (int i = 0; i < font->offset_width; i++) {
+            bits->bit = (bits->bit << 8) | offset[i];
         }
+        bits->data = font->bitmaps;
+        bits->end = font->bitmaps + font->bitmaps_len;
+        return false;
     }
 
-    if (self->use_frame_buffer) {
+    rm67162_font_obj_t *bin = font->bin;
+    const uint8_t *entry = bin->index + glyph * RM67162_FONT_ENTRY;
+    uint32_t offset = font_u32(entry + 4);
+    size_t size = font_u16(entry + 10);
+    if (bin->data != MP_OBJ_NULL) {
+        bits->data = bin->bitmaps + offset;
     } else {
-        m_free(self->frame_buffer);
+        if (bin->file == MP_OBJ_NULL) {
+            mp_raise_ValueError(MP_ERROR_TEXT("font is closed"));
+        }
+        mp_file_seek(bin->file, bin->bitmaps_offset + offset, MP_SEEK_SET);
+        size = mp_file_readinto(bin->file, bin->glyph, size);
+        bits->data = bin->glyph;
     }
-
-    return mp_const_none;
+    bits->end = bits->data + size;
+    return entry[9] & RM67162_FONT_RLE;
 }
 
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_text_obj, 5, 7, rm67162_RM67162_text);
-
-STATIC uint32_t bs_bit = 0;
-uint8_t *bitmap_data = NULL;
-
-STATIC uint8_t get_color(uint8_t bpp) {
-    uint8_t color = 0;
-    int i;
-
-    for (i = 0; i < bpp; i++) {
-        color <<= 1;
-        color |= (bitmap_data[bs_bit / 8] & 1 << (7 - (bs_bit % 8))) > 0;
-        bs_bit++;
-    }
-    return color;
-}
 
 STATIC mp_obj_t rm67162_RM67162_write_len(size_t n_args, const mp_obj_t *args) {
-    mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);
-    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(font->globals);
-    mp_obj_t widths_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTHS));
-    mp_buffer_info_t widths_bufinfo;
-    mp_get_buffer_raise(widths_data_buff, &widths_bufinfo, MP_BUFFER_READ);
-    const uint8_t *widths_data = widths_bufinfo.buf;
+    rm67162_font_t font;
+    font_get(MP_OBJ_TO_PTR(args[0]), args[1], &font);
 
     uint16_t print_width = 0;
 
-    mp_obj_t map_obj = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_MAP));
-    GET_STR_DATA_LEN(map_obj, map_data, map_len);
     GET_STR_DATA_LEN(args[2], str_data, str_len);
     const byte *s = str_data, *top = str_data + str_len;
 
@@ -1341,19 +3932,9 @@ STATIC mp_obj_t rm67162_RM67162_write_len(size_t n_args, const mp_obj_t *args) {
         ch = utf8_get_char(s);
         s = utf8_next_char(s);
 
-        const byte *map_s = map_data, *map_top = map_data + map_len;
-        uint16_t char_index = 0;
-
-        while (map_s < map_top) {
-            unichar map_ch;
-            map_ch = utf8_get_char(map_s);
-            map_s = utf8_next_char(map_s);
-
-            if (ch == map_ch) {
-                print_width += widths_data[char_index];
-                break;
-            }
-            char_index++;
+        uint8_t width;
+        if (font_find(&font, ch, &width) >= 0) {
+            print_width += width;
         }
     }
 
@@ -1362,13 +3943,15 @@ STATIC mp_obj_t rm67162_RM67162_write_len(size_t n_args, const mp_obj_t *args) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_write_len_obj, 3, 3, rm67162_RM67162_write_len);
 
 //
-//	write(font_module, s, x, y[, fg, bg, background_tuple, fill])
+//	write(font, s, x, y[, fg, bg, background_tuple, fill])
+//		font is a font module or a Font
 //		background_tuple (bitmap_buffer, width, height)
 //
 
 STATIC mp_obj_t rm67162_RM67162_write(size_t n_args, const mp_obj_t *args) {
     rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);
+    rm67162_font_t font;
+    font_get(self, args[1], &font);
 
     mp_int_t x = mp_obj_get_int(args[3]);
     mp_int_t y = mp_obj_get_int(args[4]);
@@ -1376,7 +3959,13 @@ STATIC mp_obj_t rm67162_RM67162_write(size_t n_args, const mp_obj_t *args) {
     mp_int_t bg_color;
 
     fg_color = (n_args > 5) ? mp_obj_get_int(args[5]) : WHITE;
-    bg_color = (n_args > 6) ? mp_obj_get_int(args[6]) : BLACK;
+
+    // without a bg color the glyphs are blended over the frame buffer
+    bool over_fb = n_args > 6 && args[6] == mp_const_none;
+    if (over_fb && !self->use_frame_buffer) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bg None requires use_frame_buffer"));
+    }
+    bg_color = (n_args > 6 && !over_fb) ? mp_obj_get_int(args[6]) : BLACK;
 
     mp_obj_t *tuple_data = NULL;
     size_t tuple_len = 0;
@@ -1398,124 +3987,255 @@ STATIC mp_obj_t rm67162_RM67162_write(size_t n_args, const mp_obj_t *args) {
 
     bool fill = (n_args > 8) ? mp_obj_is_true(args[8]) : false;
 
-    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(font->globals);
-    const uint8_t bpp = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BPP)));
-    const uint8_t height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
-    const uint8_t offset_width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_OFFSET_WIDTH)));
-    const uint8_t max_width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_MAX_WIDTH)));
-
-    mp_obj_t widths_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTHS));
-    mp_buffer_info_t widths_bufinfo;
-    mp_get_buffer_raise(widths_data_buff, &widths_bufinfo, MP_BUFFER_READ);
-    const uint8_t *widths_data = widths_bufinfo.buf;
+    const uint8_t bpp = font.bpp;
+    const uint8_t height = font.height;
+    const uint8_t max_width = font.max_width;
 
-    mp_obj_t offsets_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_OFFSETS));
-    mp_buffer_info_t offsets_bufinfo;
-    mp_get_buffer_raise(offsets_data_buff, &offsets_bufinfo, MP_BUFFER_READ);
-    const uint8_t *offsets_data = offsets_bufinfo.buf;
+    if (bpp < 1 || bpp > 8) {
+        mp_raise_ValueError(MP_ERROR_TEXT("BPP must be 1 to 8"));
+    }
+    uint16_t lut[256];
+    blend_lut(lut, bpp, fg_color, bg_color);
 
-    mp_obj_t bitmaps_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BITMAPS));
-    mp_buffer_info_t bitmaps_bufinfo;
-    mp_get_buffer_raise(bitmaps_data_buff, &bitmaps_bufinfo, MP_BUFFER_READ);
-    bitmap_data = bitmaps_bufinfo.buf;
+    rm67162_bits_t bits;
+    rm67162_runs_t runs;
+    runs.bpp = bpp;
 
     // allocate buffer large enough the the widest character in the font
     // if a buffer was not specified during the driver init.
     size_t buf_size = max_width * height * 2;
-    if (self->use_frame_buffer) {
-    } else {
-        self->frame_buffer = m_malloc(buf_size);
-    }
+    uint16_t *buffer = scratch_get(self, buf_size, &buf_size);
+    glyph_cache_begin(self);
 
     // if fill is set, and background bitmap data is available copy the background
     // bitmap data into the buffer. The background buffer must be the size of the
     // widest character in the font.
-    if (fill && background_data && self->frame_buffer) {
-        memcpy(self->frame_buffer, background_data, background_width * background_height * 2);
+    if (fill && background_data) {
+        memcpy(buffer, background_data, background_width * background_height * 2);
     }
 
     uint16_t print_width = 0;
-    mp_obj_t map_obj = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_MAP));
-    GET_STR_DATA_LEN(map_obj, map_data, map_len);
     GET_STR_DATA_LEN(args[2], str_data, str_len);
     const byte *s = str_data, *top = str_data + str_len;
+
+    // glyphs of a Font may be read from file, which can raise
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) != 0) {
+        scratch_put(self, buffer);
+        nlr_jump(nlr.ret_val);
+    }
+
     while (s < top) {
         unichar ch;
         ch = utf8_get_char(s);
         s = utf8_next_char(s);
 
-        const byte *map_s = map_data, *map_top = map_data + map_len;
-        uint16_t char_index = 0;
-
-        while (map_s < map_top) {
-            unichar map_ch;
-            map_ch = utf8_get_char(map_s);
-            map_s = utf8_next_char(map_s);
-
-            if (ch == map_ch) {
-                uint8_t width = widths_data[char_index];
-
-                bs_bit = 0;
-                switch (offset_width) {
-                    case 1:
-                        bs_bit = offsets_data[char_index * offset_width];
-                        break;
-
-                    case 2:
-                        bs_bit = (offsets_data[char_index * offset_width] << 8) +
-                            (offsets_data[char_index * offset_width + 1]);
-                        break;
-
-                    case 3:
-                        bs_bit = (offsets_data[char_index * offset_width] << 16) +
-                            (offsets_data[char_index * offset_width + 1] << 8) +
-                            (offsets_data[char_index * offset_width + 2]);
-                        break;
-                }
+        uint8_t width;
+        int char_index = font_find(&font, ch, &width);
+        if (char_index < 0) {
+            continue;
+        }
 
-                uint16_t buffer_width = (fill) ? max_width : width;
-
-                uint16_t color = 0;
-                for (uint16_t yy = 0; yy < height; yy++) {
-                    for (uint16_t xx = 0; xx < width; xx++) {
-                        if (background_data && (xx <= background_width && yy <= background_height)) {
-                            if (get_color(bpp) == bg_color) {
-                                color = background_data[(yy * background_width + xx)];
-                            } else {
-                                color = fg_color;
-                            }
-                        } else {
-                            color = get_color(bpp) ? fg_color : bg_color;
-                        }
-                        self->frame_buffer[yy * buffer_width + xx] = color;
+        uint16_t buffer_width = (fill) ? max_width : width;
+
+        // glyphs over a background bitmap or the frame buffer are not cached
+        bool blended = background_data || over_fb;
+        bool cacheable = self->glyphs && !blended;
+        const uint16_t *pixels = (cacheable) ? glyph_cache_find(self, args[1], char_index, fg_color, bg_color) : NULL;
+
+        if (pixels) {
+            for (uint16_t yy = 0; yy < height; yy++) {
+                memcpy(buffer + yy * buffer_width, pixels + yy * width, width * 2);
+            }
+        } else {
+            const uint16_t *frame = (over_fb) ? fb_acquire(self) : NULL;
+            uint8_t max = (1 << bpp) - 1;
+            bool rle = font_bits(&font, char_index, &bits);
+            runs.data = bits.data;
+            runs.end = bits.end;
+            runs.left = 0;
+
+            for (uint16_t yy = 0; yy < height; yy++) {
+                if (!blended) {
+                    if (rle) {
+                        runs_unpack(&runs, width, buffer + yy * buffer_width, lut);
+                    } else {
+                        bits_unpack(&bits, bpp, width, buffer + yy * buffer_width, lut);
                     }
+                    continue;
                 }
-
-                uint32_t data_size = buffer_width * height * 2;
-                uint16_t x2 = x + buffer_width - 1;
-                uint16_t y2 = y + height - 1;
-                if (x2 < self->width) {
-                    set_area(self, x, y, x2, y2);
-                    write_color(self, (uint8_t *)self->frame_buffer, data_size);
-                    print_width += width;
+                for (uint16_t xx = 0; xx < width; xx++) {
+                    uint8_t value = (rle) ? runs_get(&runs) : bits_get(&bits, bpp);
+                    uint16_t color = lut[value];
+                    int px = x + xx;
+                    int py = y + yy;
+                    const uint16_t *under = NULL;
+                    if (background_data && xx < background_width && yy < background_height) {
+                        under = &background_data[yy * background_width + xx];
+                    } else if (frame && px >= 0 && px < self->width && py >= 0 && py < self->height) {
+                        under = &frame[py * self->width + px];
+                    }
+                    if (under && value < max) {
+                        color = (value) ? blend565(fg_color, *under, coverage(value, bpp)) : *under;
+                    }
+                    buffer[yy * buffer_width + xx] = color;
                 }
-                x += width;
-                break;
             }
-            char_index++;
+
+            uint16_t *p = (cacheable) ? glyph_cache_add(self, args[1], char_index, fg_color, bg_color, width, height) : NULL;
+            for (uint16_t yy = 0; p && yy < height; yy++) {
+                memcpy(p + yy * width, buffer + yy * buffer_width, width * 2);
+            }
         }
-    }
 
-    if (self->use_frame_buffer) {
-    } else {
-        m_free(self->frame_buffer);
+        uint16_t x2 = x + buffer_width - 1;
+        if (x2 < self->width) {
+            blit_buffer(self, x, y, buffer_width, height, buffer);
+            print_width += width;
+        }
+        x += width;
     }
 
+    nlr_pop();
+    scratch_put(self, buffer);
+
     return mp_obj_new_int(print_width);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_write_obj, 5, 9, rm67162_RM67162_write);
 
 
+// Checks a Font header and takes its fields, the index follows it.
+STATIC void font_header(rm67162_font_obj_t *self, const uint8_t *header, size_t size) {
+    if (size < RM67162_FONT_HEADER || memcmp(header, "RMF1", 4) != 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("not a font file"));
+    }
+    self->bpp = header[4];
+    self->height = header[5];
+    self->max_width = header[6];
+    self->flags = header[7];
+    self->glyph_count = font_u16(header + 8);
+    self->bitmaps_offset = font_u32(header + 12);
+    if (self->bpp < 1 || self->bpp > 8 ||
+        self->bitmaps_offset < RM67162_FONT_HEADER + self->glyph_count * RM67162_FONT_ENTRY) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid font"));
+    }
+}
+
+
+// Font(path_or_buffer) opens a binary font made by scripts/font_to_bin.py for
+// write() and write_len(). A buffer, e.g. the bytes of a frozen module, is
+// used in place. From a file only the header and the glyph index are kept in
+// ram, 12 bytes a glyph, the glyphs are read when drawn. The file is closed by
+// close(), on leaving a with block or when the Font is collected.
+STATIC mp_obj_t rm67162_font_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+
+    rm67162_font_obj_t *self = m_new_obj_with_finaliser(rm67162_font_obj_t);
+    self->base.type = &rm67162_font_type;
+    self->data = MP_OBJ_NULL;
+    self->file = MP_OBJ_NULL;
+    self->bitmaps = NULL;
+    self->glyph = NULL;
+    self->glyph_size = 0;
+
+    if (!mp_obj_is_str(args[0])) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+        font_header(self, bufinfo.buf, bufinfo.len);
+        if (self->bitmaps_offset > bufinfo.len) {
+            mp_raise_ValueError(MP_ERROR_TEXT("invalid font"));
+        }
+        self->data = args[0];
+        self->index = (const uint8_t *)bufinfo.buf + RM67162_FONT_HEADER;
+        self->bitmaps = (const uint8_t *)bufinfo.buf + self->bitmaps_offset;
+
+        // glyphs are read without bounds checks when drawn, into rows of max_width
+        for (int i = 0; i < self->glyph_count; i++) {
+            const uint8_t *entry = self->index + i * RM67162_FONT_ENTRY;
+            if (font_u32(entry + 4) + font_u16(entry + 10) > bufinfo.len - self->bitmaps_offset ||
+                entry[8] > self->max_width) {
+                mp_raise_ValueError(MP_ERROR_TEXT("invalid font"));
+            }
+        }
+        return MP_OBJ_FROM_PTR(self);
+    }
+
+    mp_obj_t file = mp_file_open(mp_obj_str_get_str(args[0]), "rb");
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        uint8_t header[RM67162_FONT_HEADER];
+        font_header(self, header, mp_file_readinto(file, header, sizeof(header)));
+
+        size_t index_size = self->glyph_count * RM67162_FONT_ENTRY;
+        uint8_t *index = m_new(uint8_t, index_size);
+        if (mp_file_readinto(file, index, index_size) != index_size) {
+            mp_raise_ValueError(MP_ERROR_TEXT("invalid font"));
+        }
+        self->index = index;
+
+        for (int i = 0; i < self->glyph_count; i++) {
+            const uint8_t *entry = index + i * RM67162_FONT_ENTRY;
+            if (entry[8] > self->max_width) {
+                mp_raise_ValueError(MP_ERROR_TEXT("invalid font"));
+            }
+            self->glyph_size = MAX(self->glyph_size, font_u16(entry + 10));
+        }
+        self->glyph = m_new(uint8_t, self->glyph_size);
+        nlr_pop();
+    } else {
+        mp_file_close(file);
+        nlr_jump(nlr.ret_val);
+    }
+    self->file = file;
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+
+STATIC void rm67162_font_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void) kind;
+    rm67162_font_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "<Font glyphs=%u, height=%u, bpp=%u%s>",
+        self->glyph_count, self->height, self->bpp, (self->data != MP_OBJ_NULL) ? "" : ", file");
+}
+
+
+// close() closes the file of the font, it can no longer be drawn.
+STATIC mp_obj_t rm67162_font_close(mp_obj_t self_in) {
+    rm67162_font_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->file != MP_OBJ_NULL) {
+        mp_file_close(self->file);
+        self->file = MP_OBJ_NULL;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_font_close_obj, rm67162_font_close);
+
+
+STATIC mp_obj_t rm67162_font_exit(size_t n_args, const mp_obj_t *args) {
+    (void) n_args;
+    return rm67162_font_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_font_exit_obj, 4, 4, rm67162_font_exit);
+
+
+STATIC mp_obj_t rm67162_font_height(mp_obj_t self_in) {
+    rm67162_font_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int(self->height);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_font_height_obj, rm67162_font_height);
+
+
+STATIC const mp_rom_map_elem_t rm67162_font_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_close),     MP_ROM_PTR(&rm67162_font_close_obj)  },
+    { MP_ROM_QSTR(MP_QSTR_height),    MP_ROM_PTR(&rm67162_font_height_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj)         },
+    { MP_ROM_QSTR(MP_QSTR___exit__),  MP_ROM_PTR(&rm67162_font_exit_obj)   },
+    { MP_ROM_QSTR(MP_QSTR___del__),   MP_ROM_PTR(&rm67162_font_close_obj)  },
+};
+STATIC MP_DEFINE_CONST_DICT(rm67162_font_locals_dict, rm67162_font_locals_dict_table);
+
+
 /*---------------------------------------------------------------------------------------------------
 Below are screencontroler related functions
 ----------------------------------------------------------------------------------------------------*/
@@ -1538,9 +4258,7 @@ STATIC mp_obj_t rm67162_RM67162_mirror(mp_obj_t self_in,
         self->madctl_val &= ~(1 << 7);
     }
 
-    write_spi(self, LCD_CMD_MADCTL, (uint8_t[]) {
-            self->madctl_val
-    }, 1);
+    write_madctl(self);
 
     return mp_const_none;
 }
@@ -1557,9 +4275,7 @@ STATIC mp_obj_t rm67162_RM67162_swap_xy(mp_obj_t self_in, mp_obj_t swap_axes_in)
         self->madctl_val &= ~(1 << 5);
     }
 
-    write_spi(self, LCD_CMD_MADCTL, (uint8_t[]) {
-            self->madctl_val
-    }, 1);
+    write_madctl(self);
 
     return mp_const_none;
 }
@@ -1744,12 +4460,7 @@ STATIC mp_obj_t rm67162_RM67162_vscroll_start(size_t n_args, const mp_obj_t *arg
     } else {
         self->madctl_val &= ~LCD_CMD_ML_BIT;
     }
-    write_spi(
-        self,
-        LCD_CMD_MADCTL,
-        (uint8_t[]) { self->madctl_val, },
-        2
-    );
+    write_madctl(self);
 
     write_spi(
         self,
@@ -1763,11 +4474,71 @@ STATIC mp_obj_t rm67162_RM67162_vscroll_start(size_t n_args, const mp_obj_t *arg
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_vscroll_start_obj, 2, 3, rm67162_RM67162_vscroll_start);
 
 
+// tearing(enable[, te_pin[, line]]) switches the TE output of the panel. The
+// signal fires at scanline line; without te_pin it is polled with GDCAN.
+STATIC mp_obj_t rm67162_RM67162_tearing(size_t n_args, const mp_obj_t *args_in)
+{
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(args_in[0]);
+    bool enable = mp_obj_is_true(args_in[1]);
+
+    if (!enable) {
+        write_spi(self, LCD_CMD_TEOFF, NULL, 0);
+        self->te_enabled = false;
+        return mp_const_none;
+    }
+
+    self->te_pin = MP_OBJ_NULL;
+    if (n_args > 2 && args_in[2] != mp_const_none) {
+        self->te_pin = args_in[2];
+        mp_hal_pin_input(mp_hal_get_pin_obj(self->te_pin));
+    } else if (self->lcd_panel_p == NULL || self->lcd_panel_p->rx_param == NULL) {
+        mp_raise_ValueError(MP_ERROR_TEXT("te_pin required, the panel bus cannot read"));
+    }
+    mp_int_t line = (n_args > 3) ? mp_obj_get_int(args_in[3]) : 0;
+
+    write_spi(self, LCD_CMD_STE, (uint8_t []) { (line) >> 8, (line) & 0xFF }, 2);
+    // 0x00: V-blanking only
+    write_spi(self, LCD_CMD_TEON, (uint8_t []) { 0x00 }, 1);
+    self->te_enabled = true;
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_RM67162_tearing_obj, 2, 4, rm67162_RM67162_tearing);
+
+
+STATIC mp_obj_t rm67162_RM67162_scanline(mp_obj_t self_in)
+{
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    return mp_obj_new_int(read_scanline(self));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_RM67162_scanline_obj, rm67162_RM67162_scanline);
+
+
+// frame_rate(fps) paces show() to fps frames per second, 0 switches it off.
+STATIC mp_obj_t rm67162_RM67162_frame_rate(mp_obj_t self_in, mp_obj_t fps_in)
+{
+    rm67162_RM67162_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_int_t fps = mp_obj_get_int(fps_in);
+
+    if (fps < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("fps must be >= 0"));
+    }
+    self->frame_period_us = (fps) ? 1000000 / fps : 0;
+    self->frame_deadline = mp_hal_ticks_us();
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(rm67162_RM67162_frame_rate_obj, rm67162_RM67162_frame_rate);
+
+
 // Mapping to Micropython
 STATIC const mp_rom_map_elem_t rm67162_RM67162_locals_dict_table[] = {
     /* { MP_ROM_QSTR(MP_QSTR_custom_init),   MP_ROM_PTR(&rm67162_RM67162_custom_init_obj)   }, */
     { MP_ROM_QSTR(MP_QSTR_version),         MP_ROM_PTR(&rm67162_RM67162_version_obj)          },
     { MP_ROM_QSTR(MP_QSTR_deinit),          MP_ROM_PTR(&rm67162_RM67162_deinit_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_wait),            MP_ROM_PTR(&rm67162_RM67162_wait_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_busy),            MP_ROM_PTR(&rm67162_RM67162_busy_obj)            },
     { MP_ROM_QSTR(MP_QSTR_reset),           MP_ROM_PTR(&rm67162_RM67162_reset_obj)           },
     { MP_ROM_QSTR(MP_QSTR_init),            MP_ROM_PTR(&rm67162_RM67162_init_obj)            },
     { MP_ROM_QSTR(MP_QSTR_send_cmd),        MP_ROM_PTR(&rm67162_RM67162_send_cmd_obj)        },
@@ -1781,6 +4552,10 @@ STATIC const mp_rom_map_elem_t rm67162_RM67162_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_fill_bubble_rect),MP_ROM_PTR(&rm67162_RM67162_fill_bubble_rect_obj)},
     { MP_ROM_QSTR(MP_QSTR_fill_circle),     MP_ROM_PTR(&rm67162_RM67162_fill_circle_obj)     },
     { MP_ROM_QSTR(MP_QSTR_line),            MP_ROM_PTR(&rm67162_RM67162_line_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_fill_rects),      MP_ROM_PTR(&rm67162_RM67162_fill_rects_obj)      },
+    { MP_ROM_QSTR(MP_QSTR_hlines),          MP_ROM_PTR(&rm67162_RM67162_hlines_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_pixels),          MP_ROM_PTR(&rm67162_RM67162_pixels_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_lines),           MP_ROM_PTR(&rm67162_RM67162_lines_obj)           },
     { MP_ROM_QSTR(MP_QSTR_fill_polygon),    MP_ROM_PTR(&rm67162_RM67162_fill_polygon_obj)    },
     { MP_ROM_QSTR(MP_QSTR_polygon),         MP_ROM_PTR(&rm67162_RM67162_polygon_obj)         },
     { MP_ROM_QSTR(MP_QSTR_polygon_center),  MP_ROM_PTR(&rm67162_RM67162_polygon_center_obj)  },
@@ -1789,7 +4564,15 @@ STATIC const mp_rom_map_elem_t rm67162_RM67162_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_circle),          MP_ROM_PTR(&rm67162_RM67162_circle_obj)          },
     { MP_ROM_QSTR(MP_QSTR_colorRGB),        MP_ROM_PTR(&rm67162_RM67162_colorRGB_obj)        },
     { MP_ROM_QSTR(MP_QSTR_bitmap),          MP_ROM_PTR(&rm67162_RM67162_bitmap_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_bitmap_file),     MP_ROM_PTR(&rm67162_RM67162_bitmap_file_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_jpg),             MP_ROM_PTR(&rm67162_RM67162_jpg_obj)             },
+    { MP_ROM_QSTR(MP_QSTR_png),             MP_ROM_PTR(&rm67162_RM67162_png_obj)             },
     { MP_ROM_QSTR(MP_QSTR_text),            MP_ROM_PTR(&rm67162_RM67162_text_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_show),            MP_ROM_PTR(&rm67162_RM67162_show_obj)            },
+    { MP_ROM_QSTR(MP_QSTR_frame_buffer),    MP_ROM_PTR(&rm67162_RM67162_frame_buffer_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_dirty_rects),     MP_ROM_PTR(&rm67162_RM67162_dirty_rects_obj)     },
+    { MP_ROM_QSTR(MP_QSTR_stats),           MP_ROM_PTR(&rm67162_RM67162_stats_obj)           },
+    { MP_ROM_QSTR(MP_QSTR_reset_stats),     MP_ROM_PTR(&rm67162_RM67162_reset_stats_obj)     },
     { MP_ROM_QSTR(MP_QSTR_mirror),          MP_ROM_PTR(&rm67162_RM67162_mirror_obj)          },
     { MP_ROM_QSTR(MP_QSTR_swap_xy),         MP_ROM_PTR(&rm67162_RM67162_swap_xy_obj)         },
     { MP_ROM_QSTR(MP_QSTR_set_gap),         MP_ROM_PTR(&rm67162_RM67162_set_gap_obj)         },
@@ -1804,10 +4587,15 @@ STATIC const mp_rom_map_elem_t rm67162_RM67162_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_rotation),        MP_ROM_PTR(&rm67162_RM67162_rotation_obj)        },
     { MP_ROM_QSTR(MP_QSTR_vscroll_area),    MP_ROM_PTR(&rm67162_RM67162_vscroll_area_obj)    },
     { MP_ROM_QSTR(MP_QSTR_vscroll_start),   MP_ROM_PTR(&rm67162_RM67162_vscroll_start_obj)   },
-    { MP_ROM_QSTR(MP_QSTR___del__),         MP_ROM_PTR(&rm67162_RM67162_deinit_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_tearing),         MP_ROM_PTR(&rm67162_RM67162_tearing_obj)         },
+    { MP_ROM_QSTR(MP_QSTR_scanline),        MP_ROM_PTR(&rm67162_RM67162_scanline_obj)        },
+    { MP_ROM_QSTR(MP_QSTR_frame_rate),      MP_ROM_PTR(&rm67162_RM67162_frame_rate_obj)      },
+    { MP_ROM_QSTR(MP_QSTR___del__),         MP_ROM_PTR(&rm67162_RM67162_del_obj)             },
     { MP_ROM_QSTR(MP_QSTR_RGB),             MP_ROM_INT(COLOR_SPACE_RGB)                      },
     { MP_ROM_QSTR(MP_QSTR_BGR),             MP_ROM_INT(COLOR_SPACE_BGR)                      },
     { MP_ROM_QSTR(MP_QSTR_MONOCHROME),      MP_ROM_INT(COLOR_SPACE_MONOCHROME)               },
+    { MP_ROM_QSTR(MP_QSTR_EVEN_ODD),        MP_ROM_INT(RM67162_EVEN_ODD)                     },
+    { MP_ROM_QSTR(MP_QSTR_NON_ZERO),        MP_ROM_INT(RM67162_NON_ZERO)                     },
 };
 STATIC MP_DEFINE_CONST_DICT(rm67162_RM67162_locals_dict, rm67162_RM67162_locals_dict_table);
 
@@ -1832,13 +4620,55 @@ const mp_obj_type_t rm67162_RM67162_type = {
 #endif
 
 
+#ifdef MP_OBJ_TYPE_GET_SLOT
+MP_DEFINE_CONST_OBJ_TYPE(
+    rm67162_shape_type,
+    MP_QSTR_Shape,
+    MP_TYPE_FLAG_NONE,
+    print, rm67162_shape_print,
+    make_new, rm67162_shape_make_new
+);
+#else
+const mp_obj_type_t rm67162_shape_type = {
+    { &mp_type_type },
+    .name        = MP_QSTR_Shape,
+    .print       = rm67162_shape_print,
+    .make_new    = rm67162_shape_make_new,
+};
+#endif
+
+
+#ifdef MP_OBJ_TYPE_GET_SLOT
+MP_DEFINE_CONST_OBJ_TYPE(
+    rm67162_font_type,
+    MP_QSTR_Font,
+    MP_TYPE_FLAG_NONE,
+    print, rm67162_font_print,
+    make_new, rm67162_font_make_new,
+    locals_dict, (mp_obj_dict_t *)&rm67162_font_locals_dict
+);
+#else
+const mp_obj_type_t rm67162_font_type = {
+    { &mp_type_type },
+    .name        = MP_QSTR_Font,
+    .print       = rm67162_font_print,
+    .make_new    = rm67162_font_make_new,
+    .locals_dict = (mp_obj_dict_t *)&rm67162_font_locals_dict,
+};
+#endif
+
+
 STATIC const mp_map_elem_t mp_module_rm67162_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__),   MP_OBJ_NEW_QSTR(MP_QSTR_rm67162)          },
     { MP_ROM_QSTR(MP_QSTR_RM67162),    (mp_obj_t)&rm67162_RM67162_type       },
     { MP_ROM_QSTR(MP_QSTR_QSPIPanel),  (mp_obj_t)&rm67162_qspi_bus_type      },
+    { MP_ROM_QSTR(MP_QSTR_Shape),      (mp_obj_t)&rm67162_shape_type         },
+    { MP_ROM_QSTR(MP_QSTR_Font),       (mp_obj_t)&rm67162_font_type          },
     { MP_ROM_QSTR(MP_QSTR_RGB),        MP_ROM_INT(COLOR_SPACE_RGB)           },
     { MP_ROM_QSTR(MP_QSTR_BGR),        MP_ROM_INT(COLOR_SPACE_BGR)           },
     { MP_ROM_QSTR(MP_QSTR_MONOCHROME), MP_ROM_INT(COLOR_SPACE_MONOCHROME)    },
+    { MP_ROM_QSTR(MP_QSTR_EVEN_ODD),   MP_ROM_INT(RM67162_EVEN_ODD)          },
+    { MP_ROM_QSTR(MP_QSTR_NON_ZERO),   MP_ROM_INT(RM67162_NON_ZERO)          },
     { MP_ROM_QSTR(MP_QSTR_BLACK),      MP_ROM_INT(BLACK)                     },
     { MP_ROM_QSTR(MP_QSTR_BLUE),       MP_ROM_INT(BLUE)                      },
     { MP_ROM_QSTR(MP_QSTR_RED),        MP_ROM_INT(RED)                       },
@@ -67,10 +67,30 @@ extern "C" {
 #define YELLOW  0xE0FF
 #define WHITE   0xFFFF
 
+#define RM67162_BATCH_SIZE     32 // regions per tx_regions() call
+#define RM67162_TILE_SHIFT     4  // dirty tiles are 16x16 pixel
+#define RM67162_MAX_DIRTY      16 // rectangles show() merges the dirty tiles into
+#define RM67162_FLUSH_BUF_SIZE 0x2000 // bytes to gather the rows of a partial rectangle
+#define RM67162_TE_TIMEOUT_US  50000  // longer than a frame at the lowest refresh rate
+#define RM67162_TE_POLL_US     100    // between two polls of TE, pending events are handled
+#define RM67162_SCRATCH_SIZE   0x4000 // default size of the scratch arena in bytes
+#define RM67162_SCRATCH_SMALL  4      // small slots, an eighth of the arena each
+#define RM67162_FILL_BLOCK     2048   // pixel of the block repeated by solid fills, 4 KB
+#define RM67162_SINE_STEPS     1024   // angle steps per turn a Shape is rotated by
+#define RM67162_GLYPH_SLOTS    64     // glyphs the glyph cache holds at most
+#define RM67162_FONT_INDEXES   4      // fonts write() keeps a glyph index of
+#define RM67162_FONT_HEADER    16     // bytes of the header of a binary Font
+#define RM67162_FONT_ENTRY     12     // bytes of a glyph in the index of a Font
+#define RM67162_FONT_RLE       0x01   // Font and glyph flag: run-length encoded
+#define RM67162_PNG_ROWS       8      // rows of a band png() sends at once
+
 #define COLOR_SPACE_RGB        (0)
 #define COLOR_SPACE_BGR        (1)
 #define COLOR_SPACE_MONOCHROME (2)
 
+#define RM67162_EVEN_ODD       (0) // fill rules of fill_polygon()
+#define RM67162_NON_ZERO       (1)
+
 typedef struct _Point {
     mp_float_t x;
     mp_float_t y;
@@ -83,6 +103,14 @@ typedef struct _Polygon {
 } Polygon;
 
 
+typedef struct _rm67162_rect_t {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+} rm67162_rect_t;
+
+
 typedef struct _rm67162_rotation_t {
     uint8_t madctl;
     uint16_t width;
@@ -91,6 +119,30 @@ typedef struct _rm67162_rotation_t {
     uint16_t rowstart;
 } rm67162_rotation_t;
 
+// A glyph expanded to color565, see glyph_cache_find().
+typedef struct _rm67162_glyph_t {
+    mp_obj_t font;              // font module, kept alive while cached
+    uint32_t glyph;             // character of text(), index of write()
+    uint16_t fg;
+    uint16_t bg;
+    uint16_t width;
+    uint16_t height;
+    uint32_t used;              // glyph_tick of the last call using it
+    uint16_t *pixels;
+} rm67162_glyph_t;
+
+// A character of a write() font and its glyph, see font_index_get().
+typedef struct _rm67162_code_t {
+    uint32_t code;
+    uint32_t index;
+} rm67162_code_t;
+
+typedef struct _rm67162_font_index_t {
+    mp_obj_t map;               // MAP of the font, kept alive while indexed
+    rm67162_code_t *codes;      // sorted by code
+    uint16_t count;
+} rm67162_font_index_t;
+
 typedef struct _rm67162_RM67162_obj_t {
     mp_obj_base_t base;
     mp_obj_base_t *bus_obj;
@@ -100,7 +152,7 @@ typedef struct _rm67162_RM67162_obj_t {
     uint8_t color_space;
 	
 	// m_malloc'd pointers
-    void *work;                 // work buffer for jpg & png decoding
+    void *work;                 // work buffer for jpg & png decoding, polygon points
     uint8_t *scanline_ringbuf;  // png scanline_ringbuf
     uint8_t *palette;           // png palette
     uint8_t *trans_palette;     // png trans_palette
@@ -119,13 +171,124 @@ typedef struct _rm67162_RM67162_obj_t {
     uint8_t madctl_val; // save current value of LCD_CMD_MADCTL register
     uint8_t colmod_cal; // save surrent value of LCD_CMD_COLMOD register
 
+    // shadow of the panel registers, see set_area() and write_madctl()
+    int16_t madctl_sent;        // -1 while unknown
+    bool window_valid;
+    uint16_t window[4];         // x0, y0, x1, y1 as last sent with CASET/RASET
+    size_t window_pos;          // pixel written into the window since the last RAMWR
+    uint8_t ramwr_cmd;          // LCD_CMD_RAMWR or LCD_CMD_RAMWRC for the next write
+
+    mp_obj_t tx_obj;            // buffer of a non-blocking bitmap(), kept alive until wait()
+
+    // region batching, see batch_begin()
+    uint8_t batch_depth;
+    uint8_t batch_len;
+    rm67162_region_t batch[RM67162_BATCH_SIZE];
+    uint16_t batch_pixel[RM67162_BATCH_SIZE];  // colors of the single pixel regions
+    uint16_t *batch_line;                      // solid color source for the line regions
+    uint16_t batch_line_len;                   // capacity in pixel
+    uint16_t batch_line_fill;                  // pixel holding batch_line_color
+    uint16_t batch_line_color;
+
+    // DMA capable scratch arena, see scratch_get()
+    uint8_t *scratch;
+    size_t scratch_size;
+    uint8_t scratch_used;       // bit 0 the large slot, bits 1.. the small slots
+
+    // expanded glyphs of text() and write(), see glyph_cache_find()
+    rm67162_glyph_t *glyphs;    // RM67162_GLYPH_SLOTS entries, NULL if disabled
+    uint16_t glyph_count;
+    size_t glyph_budget;        // bytes of pixels at most
+    size_t glyph_bytes;
+    uint32_t glyph_tick;
+
+    // glyph indexes of write() fonts, see font_index_get()
+    rm67162_font_index_t font_index[RM67162_FONT_INDEXES];
+    uint8_t font_index_next;    // replaced by the next font
+
     bool use_frame_buffer;
     size_t frame_buffer_size;                       // frame buffer size in bytes
     uint16_t *frame_buffer;                         // frame buffer
+    uint16_t *front_buffer;                         // sent by show() while frame_buffer is drawn, NULL if single buffered
+
+    // dirty tracking of the frame buffer, see dirty_mark()
+    uint32_t *dirty_tiles;      // one bit per tile, tiles_x bits per tile row
+    uint16_t tiles_x;
+    uint16_t tiles_y;
+    uint16_t *flush_buf;        // RM67162_FLUSH_BUF_SIZE bytes
+
+    // frame diffing, see show_diff()
+    uint16_t *shadow_buffer;    // frame_buffer_size bytes as last sent, NULL if disabled
+    bool shadow_valid;
+
+    // presentation, see wait_te() and pace_frame()
+    bool te_enabled;
+    mp_obj_t te_pin;            // TE input, MP_OBJ_NULL to poll LCD_CMD_GDCAN
+    uint32_t frame_period_us;   // 0 if show() is not paced
+    uint32_t frame_deadline;    // mp_hal_ticks_us() of the next frame
+
+    // counters returned by stats()
+    uint32_t stat_shows;
+    uint32_t stat_rects;
+    uint32_t stat_dirty_bytes;
+    uint32_t stat_skipped_bytes;
+    uint32_t stat_missed;
+    uint32_t stat_allocs;       // scratch requests served from the heap
+    uint32_t stat_glyph_hits;
+    uint32_t stat_glyph_misses;
 } rm67162_RM67162_obj_t;
 
+// An edge of a filled polygon, stepped once per row in 16.16 fixed point. The
+// remainder of the division is carried along so the crossings stay exact.
+typedef struct _rm67162_edge_t {
+    int32_t x;          // crossing of the current row
+    int32_t step;       // x advance per row
+    int32_t error;      // remainder of x, 0 <= error < height
+    int32_t error_step;
+    int32_t height;     // 16.16 height of the edge
+    int16_t y_start;    // first row
+    int16_t y_end;      // last row
+    int8_t dir;         // +1 running down, -1 running up
+} rm67162_edge_t;
+
+
+// Polygon points converted once, see rm67162_shape_make_new().
+typedef struct _rm67162_shape_obj_t {
+    mp_obj_base_t base;
+    int16_t *points;            // x, y pairs as given
+    int32_t *fixed;             // x, y pairs rotated by angle around (cx, cy), 16.16
+    rm67162_edge_t *edges;      // edge table of fixed, sorted by first row
+    uint16_t length;
+    uint16_t edge_count;
+    bool edges_valid;
+    int16_t angle;              // in RM67162_SINE_STEPS per turn
+    int16_t cx;                 // center fixed was rotated around
+    int16_t cy;
+    int16_t center_x;           // center given to the constructor, the default of a call
+    int16_t center_y;
+} rm67162_shape_obj_t;
+
+// A binary font for write(), see rm67162_font_make_new().
+typedef struct _rm67162_font_obj_t {
+    mp_obj_base_t base;
+    mp_obj_t data;              // buffer viewed in place, MP_OBJ_NULL if read from file
+    mp_obj_t file;              // file the glyphs are read from, MP_OBJ_NULL if viewed or closed
+    const uint8_t *index;       // glyph_count entries, sorted by code
+    const uint8_t *bitmaps;     // glyphs of a viewed font
+    uint32_t bitmaps_offset;    // file offset of the glyphs of a font read from file
+    uint8_t *glyph;             // the glyph last read from file, glyph_size bytes
+    uint16_t glyph_size;
+    uint16_t glyph_count;
+    uint8_t bpp;
+    uint8_t height;
+    uint8_t max_width;
+    uint8_t flags;
+} rm67162_font_obj_t;
+
 mp_obj_t rm67162_RM67162_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args);
 extern const mp_obj_type_t rm67162_RM67162_type;
+extern const mp_obj_type_t rm67162_shape_type;
+extern const mp_obj_type_t rm67162_font_type;
 
 #ifdef  __cplusplus
 }
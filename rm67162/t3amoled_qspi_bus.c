@@ -6,6 +6,7 @@
 #include "esp_lcd_panel_ops.h"
 #include "soc/soc_caps.h"
 #include "driver/gpio.h"
+#include "esp_task.h"
 
 #include "mphalport.h"
 #include "machine_hw_spi.c"
@@ -62,7 +63,7 @@ void hal_lcd_qspi_panel_construct(mp_obj_base_t *self)
         .clock_speed_hz = qspi_panel_obj->pclk,
         .spics_io_num = -1,
         .flags = SPI_DEVICE_HALFDUPLEX,
-        .queue_size = 10,
+        .queue_size = QSPI_PANEL_QUEUE_SIZE,
     };
 
     ret = spi_bus_add_device(spi_obj->host, &devcfg, &spi_obj->spi);
@@ -72,6 +73,120 @@ void hal_lcd_qspi_panel_construct(mp_obj_base_t *self)
 }
 
 
+STATIC void hal_lcd_qspi_panel_get_size(mp_obj_base_t *self, uint16_t *width, uint16_t *height)
+{
+    rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
+
+    *width = qspi_panel_obj->width;
+    *height = qspi_panel_obj->height;
+}
+
+
+STATIC void hal_lcd_qspi_panel_wait(mp_obj_base_t *self)
+{
+    rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
+
+    if (qspi_panel_obj->tx_pending) {
+        xSemaphoreTake(qspi_panel_obj->tx_done, portMAX_DELAY);
+        qspi_panel_obj->tx_pending = false;
+        qspi_panel_obj->tx_obj = MP_OBJ_NULL;
+    }
+}
+
+
+STATIC bool hal_lcd_qspi_panel_busy(mp_obj_base_t *self)
+{
+    rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
+
+    if (qspi_panel_obj->tx_pending && xSemaphoreTake(qspi_panel_obj->tx_done, 0) == pdTRUE) {
+        qspi_panel_obj->tx_pending = false;
+        qspi_panel_obj->tx_obj = MP_OBJ_NULL;
+    }
+    return qspi_panel_obj->tx_pending;
+}
+
+
+/*
+Transaction builders, shared by the single, batched and queued paths.
+*/
+
+STATIC void hal_lcd_qspi_panel_param_trans(spi_transaction_t *t,
+                                           int                cmd_bits,
+                                           int                lcd_cmd,
+                                           const void        *param,
+                                           size_t             param_size)
+{
+    memset(t, 0, sizeof(*t));
+    t->flags = (SPI_TRANS_MULTILINE_CMD | SPI_TRANS_MULTILINE_ADDR);
+    t->cmd = 0x02;
+    t->addr = lcd_cmd << 8;
+    if (param_size != 0) {
+        t->tx_buffer = param;
+        t->length = cmd_bits * param_size;
+    } else {
+        t->tx_buffer = NULL;
+        t->length = 0;
+    }
+}
+
+
+// The first chunk carries the RAMWR header itself, the following chunks
+// continue the same CS assertion without cmd/addr phase.
+STATIC void hal_lcd_qspi_panel_color_trans(spi_transaction_ext_t *t,
+                                           int                    lcd_cmd,
+                                           bool                   first,
+                                           const uint8_t         *p_color,
+                                           size_t                 chunk_size)
+{
+    memset(t, 0, sizeof(*t));
+    if (first) {
+        // RAMWR or RAMWRC, 0 is kept as RAMWR for older callers
+        t->base.flags = SPI_TRANS_MODE_QIO;
+        t->base.cmd = 0x32;
+        t->base.addr = ((lcd_cmd) ? lcd_cmd : LCD_CMD_RAMWR) << 8;
+    } else {
+        t->base.flags = SPI_TRANS_MODE_QIO | \
+                        SPI_TRANS_VARIABLE_CMD | \
+                        SPI_TRANS_VARIABLE_ADDR | \
+                        SPI_TRANS_VARIABLE_DUMMY;
+        t->command_bits = 0;
+        t->address_bits = 0;
+        t->dummy_bits = 0;
+    }
+    t->base.tx_buffer = (chunk_size) ? p_color : NULL;
+    t->base.length = chunk_size * 8;
+}
+
+
+STATIC void hal_lcd_qspi_panel_polling_color(rm67162_qspi_bus_obj_t *qspi_panel_obj,
+                                             int                     lcd_cmd,
+                                             const uint8_t          *p_color,
+                                             size_t                  len)
+{
+    machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
+    spi_transaction_ext_t t;
+    size_t chunk_size;
+    bool first = true;
+
+    mp_hal_pin_od_low(qspi_panel_obj->cs_pin);
+    do {
+        if (len > QSPI_PANEL_CHUNK_SIZE) {
+            chunk_size = QSPI_PANEL_CHUNK_SIZE;
+        } else {
+            chunk_size = len;
+        }
+        hal_lcd_qspi_panel_color_trans(&t, lcd_cmd, first, p_color, chunk_size);
+        spi_device_polling_transmit(spi_obj->spi, (spi_transaction_t *)&t);
+        qspi_panel_obj->trans_count++;
+        qspi_panel_obj->trans_bytes += chunk_size;
+        first = false;
+        len -= chunk_size;
+        p_color += chunk_size;
+    } while (len > 0);
+    mp_hal_pin_od_high(qspi_panel_obj->cs_pin);
+}
+
+
 STATIC void hal_lcd_qspi_panel_tx_param(mp_obj_base_t *self,
                                         int            lcd_cmd,
                                         const void    *param,
@@ -82,20 +197,14 @@ STATIC void hal_lcd_qspi_panel_tx_param(mp_obj_base_t *self,
     rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
     machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
     spi_transaction_t t;
-    memset(&t, 0, sizeof(t));
-    t.flags = (SPI_TRANS_MULTILINE_CMD | SPI_TRANS_MULTILINE_ADDR);
-    t.cmd = 0x02;
-    t.addr = lcd_cmd << 8;
-    if (param_size != 0) {
-        t.tx_buffer = param;
-        t.length = qspi_panel_obj->cmd_bits * param_size;
-    } else {
-        t.tx_buffer = NULL;
-        t.length = 0;
-    }
+
+    hal_lcd_qspi_panel_wait(self);
+    hal_lcd_qspi_panel_param_trans(&t, qspi_panel_obj->cmd_bits, lcd_cmd, param, param_size);
     mp_hal_pin_od_low(qspi_panel_obj->cs_pin);
     spi_device_polling_transmit(spi_obj->spi, &t);
     mp_hal_pin_od_high(qspi_panel_obj->cs_pin);
+    qspi_panel_obj->trans_count++;
+    qspi_panel_obj->trans_bytes += param_size;
 }
 
 
@@ -104,53 +213,216 @@ STATIC void hal_lcd_qspi_panel_tx_color(mp_obj_base_t *self,
                                         const void    *color,
                                         size_t         color_size)
 {
-    DEBUG_printf("hal_lcd_qspi_panel_tx_color cmd:, color_size: %u\n", /* lcd_cmd, */ color_size);
+    DEBUG_printf("hal_lcd_qspi_panel_tx_color cmd: %x, color_size: %u\n", lcd_cmd, color_size);
+
+    rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
+
+    hal_lcd_qspi_panel_wait(self);
+    hal_lcd_qspi_panel_polling_color(qspi_panel_obj, lcd_cmd, (const uint8_t *)color, color_size);
+}
+
+
+// Solid fills. The same small block is queued again and again within one CS
+// assertion, with up to QSPI_PANEL_QUEUE_SIZE descriptors in flight, the last
+// one cut to the remaining size.
+STATIC void hal_lcd_qspi_panel_tx_color_repeat(mp_obj_base_t *self,
+                                               int            lcd_cmd,
+                                               const void    *color,
+                                               size_t         color_size,
+                                               size_t         total_size)
+{
+    DEBUG_printf("hal_lcd_qspi_panel_tx_color_repeat cmd: %x, color_size: %u, total_size: %u\n", lcd_cmd, color_size, total_size);
 
     rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
     machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
-    spi_transaction_ext_t t;
+    spi_transaction_ext_t *t;
+    spi_transaction_t *done;
+    size_t slot = 0;
+    size_t in_flight = 0;
+    bool first = true;
+
+    hal_lcd_qspi_panel_wait(self);
+    if (color_size == 0 || total_size == 0) {
+        return;
+    }
 
+    // the queue is idle after wait(), so the async descriptors can be reused
     mp_hal_pin_od_low(qspi_panel_obj->cs_pin);
-    memset(&t, 0, sizeof(t));
-    t.base.flags = SPI_TRANS_MODE_QIO;
-    t.base.cmd = 0x32;
-    t.base.addr = 0x002C00;
-    spi_device_polling_transmit(spi_obj->spi, (spi_transaction_t *)&t);
-
-    uint8_t *p_color = (uint8_t *)color;
-    size_t chunk_size;
-    size_t len = color_size;
-    memset(&t, 0, sizeof(t));
-    t.base.flags = SPI_TRANS_MODE_QIO | \
-                    SPI_TRANS_VARIABLE_CMD | \
-                    SPI_TRANS_VARIABLE_ADDR | \
-                    SPI_TRANS_VARIABLE_DUMMY;
-    t.command_bits = 0;
-    t.address_bits = 0;
-    t.dummy_bits = 0;
-    
-    do {
-        if (len > 0x8000) { //32 KB
-            chunk_size = 0x8000;
+    while (total_size > 0 || in_flight > 0) {
+        if (total_size > 0 && in_flight < QSPI_PANEL_QUEUE_SIZE) {
+            size_t chunk_size = (total_size > color_size) ? color_size : total_size;
+            t = &qspi_panel_obj->trans[slot];
+            slot = (slot + 1) % QSPI_PANEL_QUEUE_SIZE;
+            hal_lcd_qspi_panel_color_trans(t, lcd_cmd, first, color, chunk_size);
+            spi_device_queue_trans(spi_obj->spi, (spi_transaction_t *)t, portMAX_DELAY);
+            qspi_panel_obj->trans_count++;
+            qspi_panel_obj->trans_bytes += chunk_size;
+            first = false;
+            in_flight++;
+            total_size -= chunk_size;
         } else {
-            chunk_size = len;
+            spi_device_get_trans_result(spi_obj->spi, &done, portMAX_DELAY);
+            in_flight--;
         }
-        t.base.tx_buffer = p_color;
-        t.base.length = chunk_size * 8;
-        spi_device_polling_transmit(spi_obj->spi, (spi_transaction_t *)&t);
-        len -= chunk_size;
-        p_color += chunk_size;
-    } while (len > 0);
-
+    }
     mp_hal_pin_od_high(qspi_panel_obj->cs_pin);
 }
 
 
+/*
+Batched submission. The bus is acquired once for the whole list and every
+region costs CASET + RASET + RAMWR with data, each built in place. The
+address commands are left out when the region is flagged to keep them.
+*/
+
+STATIC void hal_lcd_qspi_panel_tx_regions(mp_obj_base_t          *self,
+                                          const rm67162_region_t *regions,
+                                          size_t                  count)
+{
+    DEBUG_printf("hal_lcd_qspi_panel_tx_regions count: %u\n", count);
+
+    rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
+    machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
+    spi_transaction_t t;
+
+    hal_lcd_qspi_panel_wait(self);
+    spi_device_acquire_bus(spi_obj->spi, portMAX_DELAY);
+    for (size_t i = 0; i < count; i++) {
+        const rm67162_region_t *region = &regions[i];
+
+        if (!(region->flags & QSPI_REGION_KEEP_CASET)) {
+            hal_lcd_qspi_panel_param_trans(&t, qspi_panel_obj->cmd_bits, LCD_CMD_CASET, NULL, 0);
+            t.flags |= SPI_TRANS_USE_TXDATA;
+            t.tx_data[0] = (region->x0 >> 8) & 0xFF;
+            t.tx_data[1] = region->x0 & 0xFF;
+            t.tx_data[2] = (region->x1 >> 8) & 0xFF;
+            t.tx_data[3] = region->x1 & 0xFF;
+            t.length = 32;
+            mp_hal_pin_od_low(qspi_panel_obj->cs_pin);
+            spi_device_polling_transmit(spi_obj->spi, &t);
+            mp_hal_pin_od_high(qspi_panel_obj->cs_pin);
+            qspi_panel_obj->trans_count++;
+            qspi_panel_obj->trans_bytes += 4;
+        }
+
+        if (!(region->flags & QSPI_REGION_KEEP_RASET)) {
+            hal_lcd_qspi_panel_param_trans(&t, qspi_panel_obj->cmd_bits, LCD_CMD_RASET, NULL, 0);
+            t.flags |= SPI_TRANS_USE_TXDATA;
+            t.tx_data[0] = (region->y0 >> 8) & 0xFF;
+            t.tx_data[1] = region->y0 & 0xFF;
+            t.tx_data[2] = (region->y1 >> 8) & 0xFF;
+            t.tx_data[3] = region->y1 & 0xFF;
+            t.length = 32;
+            mp_hal_pin_od_low(qspi_panel_obj->cs_pin);
+            spi_device_polling_transmit(spi_obj->spi, &t);
+            mp_hal_pin_od_high(qspi_panel_obj->cs_pin);
+            qspi_panel_obj->trans_count++;
+            qspi_panel_obj->trans_bytes += 4;
+        }
+
+        hal_lcd_qspi_panel_polling_color(qspi_panel_obj, LCD_CMD_RAMWR, region->color, region->color_size);
+    }
+    spi_device_release_bus(spi_obj->spi);
+}
+
+
+/*
+Queued transmission. The chunks are queued from tx_task, which keeps at most
+QSPI_PANEL_ASYNC_DEPTH of them in flight, so the micropython task is free to
+render the next frame while the dma is busy.
+*/
+
+STATIC void hal_lcd_qspi_panel_tx_task(void *arg)
+{
+    rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)arg;
+    machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
+    spi_transaction_ext_t *t;
+    spi_transaction_t *done;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        const uint8_t *p_color = qspi_panel_obj->tx_buf;
+        size_t len = qspi_panel_obj->tx_len;
+        size_t slot = 0;
+        size_t in_flight = 0;
+        bool first = true;
+
+        mp_hal_pin_od_low(qspi_panel_obj->cs_pin);
+        while (len > 0 || in_flight > 0) {
+            if (len > 0 && in_flight < QSPI_PANEL_ASYNC_DEPTH) {
+                size_t chunk_size = (len > QSPI_PANEL_CHUNK_SIZE) ? QSPI_PANEL_CHUNK_SIZE : len;
+                // a slot is only reused after QSPI_PANEL_QUEUE_SIZE - QSPI_PANEL_ASYNC_DEPTH results were collected
+                t = &qspi_panel_obj->trans[slot];
+                slot = (slot + 1) % QSPI_PANEL_QUEUE_SIZE;
+                hal_lcd_qspi_panel_color_trans(t, qspi_panel_obj->tx_cmd, first, p_color, chunk_size);
+                spi_device_queue_trans(spi_obj->spi, (spi_transaction_t *)t, portMAX_DELAY);
+                qspi_panel_obj->trans_count++;
+                qspi_panel_obj->trans_bytes += chunk_size;
+                first = false;
+                in_flight++;
+                len -= chunk_size;
+                p_color += chunk_size;
+            } else {
+                spi_device_get_trans_result(spi_obj->spi, &done, portMAX_DELAY);
+                in_flight--;
+            }
+        }
+
+        mp_hal_pin_od_high(qspi_panel_obj->cs_pin);
+        xSemaphoreGive(qspi_panel_obj->tx_done);
+    }
+}
+
+
+STATIC void hal_lcd_qspi_panel_tx_color_async(mp_obj_base_t *self,
+                                              int            lcd_cmd,
+                                              const void    *color,
+                                              size_t         color_size)
+{
+    DEBUG_printf("hal_lcd_qspi_panel_tx_color_async color_size: %u\n", color_size);
+
+    rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
+
+    hal_lcd_qspi_panel_wait(self);
+    if (color_size == 0) {
+        return;
+    }
+
+    if (qspi_panel_obj->tx_task == NULL) {
+        qspi_panel_obj->tx_done = xSemaphoreCreateBinary();
+        if (qspi_panel_obj->tx_done == NULL) {
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to create the transmission semaphore."));
+        }
+        if (xTaskCreate(hal_lcd_qspi_panel_tx_task, "qspi_tx", 3072, qspi_panel_obj,
+                        ESP_TASK_PRIO_MIN + 2, &qspi_panel_obj->tx_task) != pdPASS) {
+            vSemaphoreDelete(qspi_panel_obj->tx_done);
+            qspi_panel_obj->tx_task = NULL;
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to create the transmission task."));
+        }
+    }
+
+    qspi_panel_obj->tx_cmd = lcd_cmd;
+    qspi_panel_obj->tx_buf = (const uint8_t *)color;
+    qspi_panel_obj->tx_len = color_size;
+    qspi_panel_obj->tx_pending = true;
+    xTaskNotifyGive(qspi_panel_obj->tx_task);
+}
+
+
 STATIC void hal_lcd_qspi_panel_deinit(mp_obj_base_t *self)
 {
     rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
     machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
-    
+
+    hal_lcd_qspi_panel_wait(self);
+    if (qspi_panel_obj->tx_task) {
+        vTaskDelete(qspi_panel_obj->tx_task);
+        vSemaphoreDelete(qspi_panel_obj->tx_done);
+        qspi_panel_obj->tx_task = NULL;
+        qspi_panel_obj->tx_done = NULL;
+    }
+
     if (spi_obj->state == MACHINE_HW_SPI_STATE_INIT) {
         spi_obj->state = MACHINE_HW_SPI_STATE_DEINIT;
         machine_hw_spi_deinit_internal(spi_obj);
@@ -214,8 +486,8 @@ STATIC mp_obj_t rm67162_qspi_bus_make_new(const mp_obj_type_t *type,
         make_new_args, args
     );
 
-    // create new object
-    rm67162_qspi_bus_obj_t *self = m_new_obj(rm67162_qspi_bus_obj_t);
+    // create new object, __del__ stops tx_task before the object goes away
+    rm67162_qspi_bus_obj_t *self = m_new_obj_with_finaliser(rm67162_qspi_bus_obj_t);
     self->base.type = &rm67162_qspi_bus_type;
     self->spi_obj = MP_OBJ_TO_PTR(args[ARG_spi].u_obj);
 
@@ -233,6 +505,12 @@ STATIC mp_obj_t rm67162_qspi_bus_make_new(const mp_obj_type_t *type,
     self->height     = args[ARG_height].u_int;
     self->cmd_bits   = args[ARG_cmd_bits].u_int;
     self->param_bits = args[ARG_param_bits].u_int;
+    self->tx_task    = NULL;
+    self->tx_done    = NULL;
+    self->tx_pending = false;
+    self->tx_obj     = MP_OBJ_NULL;
+    self->trans_count = 0;
+    self->trans_bytes = 0;
 
     hal_lcd_qspi_panel_construct(&self->base);
     return MP_OBJ_FROM_PTR(self);
@@ -256,6 +534,33 @@ STATIC mp_obj_t rm67162_qspi_bus_tx_param(size_t n_args, const mp_obj_t *args_in
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_qspi_bus_tx_param_obj, 2, 3, rm67162_qspi_bus_tx_param);
 
 
+// The read command 0x03 clocks the parameters back on a single line.
+STATIC void hal_lcd_qspi_panel_rx_param(mp_obj_base_t *self,
+                                        int            lcd_cmd,
+                                        void          *param,
+                                        size_t         param_size)
+{
+    rm67162_qspi_bus_obj_t *qspi_panel_obj = (rm67162_qspi_bus_obj_t *)self;
+    machine_hw_spi_obj_t *spi_obj = ((machine_hw_spi_obj_t *)qspi_panel_obj->spi_obj);
+    spi_transaction_t t;
+
+    if (param_size > 4) {
+        param_size = 4;
+    }
+    hal_lcd_qspi_panel_wait(self);
+    memset(&t, 0, sizeof(t));
+    t.flags = SPI_TRANS_USE_RXDATA;
+    t.cmd = 0x03;
+    t.addr = lcd_cmd << 8;
+    t.rxlength = param_size * 8;
+    mp_hal_pin_od_low(qspi_panel_obj->cs_pin);
+    spi_device_polling_transmit(spi_obj->spi, &t);
+    mp_hal_pin_od_high(qspi_panel_obj->cs_pin);
+    memcpy(param, t.rx_data, param_size);
+    qspi_panel_obj->trans_count++;
+}
+
+
 STATIC mp_obj_t rm67162_qspi_bus_tx_color(size_t n_args, const mp_obj_t *args_in)
 {
     mp_obj_base_t *self = (mp_obj_base_t *)MP_OBJ_TO_PTR(args_in[0]);
@@ -274,6 +579,85 @@ STATIC mp_obj_t rm67162_qspi_bus_tx_color(size_t n_args, const mp_obj_t *args_in
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(rm67162_qspi_bus_tx_color_obj, 2, 3, rm67162_qspi_bus_tx_color);
 
 
+STATIC mp_obj_t rm67162_qspi_bus_rx_param(mp_obj_t self_in, mp_obj_t cmd_in, mp_obj_t len_in)
+{
+    mp_obj_base_t *self = (mp_obj_base_t *)MP_OBJ_TO_PTR(self_in);
+    int cmd = mp_obj_get_int(cmd_in);
+    size_t len = mp_obj_get_int(len_in);
+    uint8_t buf[4];
+
+    if (len > 4) {
+        mp_raise_ValueError(MP_ERROR_TEXT("at most 4 bytes can be read"));
+    }
+    hal_lcd_qspi_panel_rx_param(self, cmd, buf, len);
+    return mp_obj_new_bytes(buf, len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(rm67162_qspi_bus_rx_param_obj, rm67162_qspi_bus_rx_param);
+
+
+STATIC mp_obj_t rm67162_qspi_bus_tx_color_async(mp_obj_t self_in, mp_obj_t cmd_in, mp_obj_t buf_in)
+{
+    rm67162_qspi_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    int cmd = mp_obj_get_int(cmd_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
+
+    hal_lcd_qspi_panel_tx_color_async(&self->base, cmd, bufinfo.buf, bufinfo.len);
+    if (self->tx_pending) {
+        self->tx_obj = buf_in;
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(rm67162_qspi_bus_tx_color_async_obj, rm67162_qspi_bus_tx_color_async);
+
+
+STATIC mp_obj_t rm67162_qspi_bus_wait(mp_obj_t self_in)
+{
+    mp_obj_base_t *self = (mp_obj_base_t *)MP_OBJ_TO_PTR(self_in);
+
+    hal_lcd_qspi_panel_wait(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_qspi_bus_wait_obj, rm67162_qspi_bus_wait);
+
+
+STATIC mp_obj_t rm67162_qspi_bus_busy(mp_obj_t self_in)
+{
+    mp_obj_base_t *self = (mp_obj_base_t *)MP_OBJ_TO_PTR(self_in);
+
+    return mp_obj_new_bool(hal_lcd_qspi_panel_busy(self));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_qspi_bus_busy_obj, rm67162_qspi_bus_busy);
+
+
+// Returns (transactions, bytes) sent since construction or the last reset_stats().
+STATIC mp_obj_t rm67162_qspi_bus_stats(mp_obj_t self_in)
+{
+    rm67162_qspi_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    hal_lcd_qspi_panel_wait(&self->base);
+    mp_obj_t stats[2] = {
+        mp_obj_new_int_from_uint(self->trans_count),
+        mp_obj_new_int_from_uint(self->trans_bytes)
+    };
+    return mp_obj_new_tuple(2, stats);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_qspi_bus_stats_obj, rm67162_qspi_bus_stats);
+
+
+STATIC mp_obj_t rm67162_qspi_bus_reset_stats(mp_obj_t self_in)
+{
+    rm67162_qspi_bus_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    hal_lcd_qspi_panel_wait(&self->base);
+    self->trans_count = 0;
+    self->trans_bytes = 0;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_qspi_bus_reset_stats_obj, rm67162_qspi_bus_reset_stats);
+
+
 STATIC mp_obj_t rm67162_qspi_bus_deinit(mp_obj_t self_in)
 {
     mp_obj_base_t *self = (mp_obj_base_t *)MP_OBJ_TO_PTR(self_in);
@@ -286,17 +670,30 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(rm67162_qspi_bus_deinit_obj, rm67162_qspi_bus_d
 
 
 STATIC const mp_rom_map_elem_t rm67162_qspi_bus_locals_dict_table[] = {
-    { MP_ROM_QSTR(MP_QSTR_tx_param), MP_ROM_PTR(&rm67162_qspi_bus_tx_param_obj) },
-    { MP_ROM_QSTR(MP_QSTR_tx_color), MP_ROM_PTR(&rm67162_qspi_bus_tx_color_obj) },
-    { MP_ROM_QSTR(MP_QSTR_deinit),   MP_ROM_PTR(&rm67162_qspi_bus_deinit_obj)   },
-    { MP_ROM_QSTR(MP_QSTR___del__),  MP_ROM_PTR(&rm67162_qspi_bus_deinit_obj)   },
+    { MP_ROM_QSTR(MP_QSTR_tx_param),       MP_ROM_PTR(&rm67162_qspi_bus_tx_param_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_rx_param),       MP_ROM_PTR(&rm67162_qspi_bus_rx_param_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_tx_color),       MP_ROM_PTR(&rm67162_qspi_bus_tx_color_obj)       },
+    { MP_ROM_QSTR(MP_QSTR_tx_color_async), MP_ROM_PTR(&rm67162_qspi_bus_tx_color_async_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait),           MP_ROM_PTR(&rm67162_qspi_bus_wait_obj)           },
+    { MP_ROM_QSTR(MP_QSTR_busy),           MP_ROM_PTR(&rm67162_qspi_bus_busy_obj)           },
+    { MP_ROM_QSTR(MP_QSTR_stats),          MP_ROM_PTR(&rm67162_qspi_bus_stats_obj)          },
+    { MP_ROM_QSTR(MP_QSTR_reset_stats),    MP_ROM_PTR(&rm67162_qspi_bus_reset_stats_obj)    },
+    { MP_ROM_QSTR(MP_QSTR_deinit),         MP_ROM_PTR(&rm67162_qspi_bus_deinit_obj)         },
+    { MP_ROM_QSTR(MP_QSTR___del__),        MP_ROM_PTR(&rm67162_qspi_bus_deinit_obj)         },
 };
 STATIC MP_DEFINE_CONST_DICT(rm67162_qspi_bus_locals_dict, rm67162_qspi_bus_locals_dict_table);
 
 
 STATIC const rm67162_panel_p_t mp_lcd_panel_p = {
+    .get_size = hal_lcd_qspi_panel_get_size,
     .tx_param = hal_lcd_qspi_panel_tx_param,
+    .rx_param = hal_lcd_qspi_panel_rx_param,
     .tx_color = hal_lcd_qspi_panel_tx_color,
+    .tx_color_async = hal_lcd_qspi_panel_tx_color_async,
+    .tx_color_repeat = hal_lcd_qspi_panel_tx_color_repeat,
+    .tx_regions = hal_lcd_qspi_panel_tx_regions,
+    .wait = hal_lcd_qspi_panel_wait,
+    .busy = hal_lcd_qspi_panel_busy,
     .deinit = hal_lcd_qspi_panel_deinit
 };
 
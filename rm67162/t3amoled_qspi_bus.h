@@ -5,12 +5,46 @@
 #include "py/obj.h"
 #include "esp_lcd_panel_io.h"
 #include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 
+#define QSPI_PANEL_QUEUE_SIZE  10     // queue_size of the spi device
+#define QSPI_PANEL_ASYNC_DEPTH 2      // chunks in flight, each may need a DMA bounce buffer
+#define QSPI_PANEL_CHUNK_SIZE  0x8000 // 32 KB
+
+
+#define QSPI_REGION_KEEP_CASET 0x01 // column window equals the previous one
+#define QSPI_REGION_KEEP_RASET 0x02 // row window equals the previous one
+
+// One address window and the pixel data to write into it.
+typedef struct _rm67162_region_t {
+    uint16_t x0;
+    uint16_t y0;
+    uint16_t x1;
+    uint16_t y1;
+    uint8_t flags;
+    const void *color;
+    size_t color_size;
+} rm67162_region_t;
+
 
 typedef struct _rm67162_panel_p_t {
+    // the panel size in pixel, as configured on the bus
+    void (*get_size)(mp_obj_base_t *self, uint16_t *width, uint16_t *height);
     void (*tx_param)(mp_obj_base_t *self, int lcd_cmd, const void *param, size_t param_size);
+    // reads up to 4 parameter bytes of a register, e.g. LCD_CMD_GDCAN
+    void (*rx_param)(mp_obj_base_t *self, int lcd_cmd, void *param, size_t param_size);
     void (*tx_color)(mp_obj_base_t *self, int lcd_cmd, const void *color, size_t color_size);
+    // returns immediately, color must stay untouched until wait() returns
+    void (*tx_color_async)(mp_obj_base_t *self, int lcd_cmd, const void *color, size_t color_size);
+    // sends total_size bytes repeating color, color_size bytes, within one RAMWR
+    void (*tx_color_repeat)(mp_obj_base_t *self, int lcd_cmd, const void *color, size_t color_size, size_t total_size);
+    // CASET + RASET + RAMWR for every region, with the bus acquired once
+    void (*tx_regions)(mp_obj_base_t *self, const rm67162_region_t *regions, size_t count);
+    void (*wait)(mp_obj_base_t *self);
+    bool (*busy)(mp_obj_base_t *self);
     void (*deinit)(mp_obj_base_t *self);
 } rm67162_panel_p_t;
 
@@ -34,6 +68,20 @@ typedef struct _rm67162_qspi_bus_obj_t {
     int cmd_bits;
     int param_bits;
 
+    // queued transmission, fed by tx_task so the caller does not have to wait
+    spi_transaction_ext_t trans[QSPI_PANEL_QUEUE_SIZE];
+    TaskHandle_t tx_task;
+    SemaphoreHandle_t tx_done;
+    bool tx_pending;            // only touched by the micropython task
+    int tx_cmd;
+    const uint8_t *tx_buf;
+    size_t tx_len;
+    mp_obj_t tx_obj;            // keeps the buffer passed from python alive
+
+    // transactions and payload bytes sent, see stats()
+    uint32_t trans_count;
+    uint32_t trans_bytes;
+
     // spi_device_handle_t io_handle;
     enum {
         MACHINE_HW_QSPI_STATE_NONE,
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+Converts a font module to the binary font format of rm67162.Font.
+
+    font_to_bin.py fonts/bitmap/vga1_bold_16x32.py vga1_bold_16x32.rmf
+    font_to_bin.py --rle fonts/bitmap/vga1_bold_16x32.py
+
+Both the 1 bit fonts of text() (WIDTH, HEIGHT, FIRST, LAST, FONT) and the
+fonts of write() (MAP, BPP, HEIGHT, MAX_WIDTH, OFFSET_WIDTH, WIDTHS, OFFSETS,
+BITMAPS) are converted. Either way the Font is drawn with write(), text() only
+takes font modules.
+
+The format is little-endian:
+
+    offset  size
+    0       4       magic b"RMF1"
+    4       1       bits per pixel
+    5       1       height
+    6       1       widest glyph
+    7       1       flags, bit 0 set if glyphs are run-length encoded
+    8       2       number of glyphs
+    10      2       0
+    12      4       file offset of the glyphs
+    16      12 * n  glyph index sorted by code point:
+                        code point u32, offset from the glyphs u32,
+                        width u8, flags u8, length in bytes u16
+                    flags bit 0 is set if the glyph is run-length encoded
+
+Each glyph starts on a byte and holds its rows of width * bpp bits one after
+the other, the first pixel in the most significant bits.
+
+Run-length encoded glyphs are runs of equal pixel values over all rows. At
+1 bpp a run is one byte, the value in bit 7 and the length - 1 in bits 0-6.
+Otherwise it is a byte of the length - 1 followed by a byte of the value.
+With --rle a glyph is encoded so only where that is smaller, which is the
+case for the larger fonts.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b"RMF1"
+FLAG_RLE = 0x01
+HEADER = "<4sBBBBHHI"
+ENTRY = "<IIBBH"
+
+
+def load_font(path):
+    """The globals of a font module, run without importing it."""
+    font = {}
+    with open(path) as f:
+        exec(compile(f.read(), path, "exec"), font)
+    return font
+
+
+def get_bits(data, bit, count):
+    """count bits of data starting at bit, as an int."""
+    value = 0
+    for i in range(bit, bit + count):
+        value = (value << 1) | ((data[i >> 3] >> (7 - (i & 7))) & 1)
+    return value
+
+
+def pack_bits(values, bpp):
+    """Packs pixel values of bpp bits into bytes, padded to a byte."""
+    out = bytearray()
+    acc = 0
+    nbits = 0
+    for value in values:
+        acc = (acc << bpp) | value
+        nbits += bpp
+        while nbits >= 8:
+            nbits -= 8
+            out.append((acc >> nbits) & 0xFF)
+    if nbits:
+        out.append((acc << (8 - nbits)) & 0xFF)
+    return bytes(out)
+
+
+def encode_runs(values, bpp):
+    """Run-length encodes pixel values of bpp bits."""
+    limit = 128 if bpp == 1 else 256
+    out = bytearray()
+    i = 0
+    while i < len(values):
+        value = values[i]
+        n = 1
+        while n < limit and i + n < len(values) and values[i + n] == value:
+            n += 1
+        if bpp == 1:
+            out.append((value << 7) | (n - 1))
+        else:
+            out += bytes((n - 1, value))
+        i += n
+    return bytes(out)
+
+
+def text_glyphs(font):
+    """Glyphs of a text() font, rows are padded to whole bytes."""
+    width = font["WIDTH"]
+    height = font["HEIGHT"]
+    wide = (width + 7) // 8
+    size = wide * height
+    data = bytes(font["FONT"])
+    for code in range(font["FIRST"], font["LAST"] + 1):
+        start = (code - font["FIRST"]) * size
+        pixels = []
+        for row in range(height):
+            base = (start + row * wide) * 8
+            pixels.extend(get_bits(data, base + col, 1) for col in range(width))
+        yield code, width, pixels
+    font["BPP"] = 1
+    font["MAX_WIDTH"] = width
+
+
+def write_glyphs(font):
+    """Glyphs of a write() font, which start at any bit of BITMAPS."""
+    bpp = font["BPP"]
+    height = font["HEIGHT"]
+    offset_width = font["OFFSET_WIDTH"]
+    widths = bytes(font["WIDTHS"])
+    offsets = bytes(font["OFFSETS"])
+    bitmaps = bytes(font["BITMAPS"])
+    for index, char in enumerate(font["MAP"]):
+        offset = int.from_bytes(offsets[index * offset_width:(index + 1) * offset_width], "big")
+        width = widths[index]
+        pixels = [get_bits(bitmaps, offset + i * bpp, bpp) for i in range(width * height)]
+        yield ord(char), width, pixels
+
+
+def convert(font, rle=False):
+    """The binary font of the globals of a font module."""
+    glyphs = text_glyphs(font) if "FONT" in font else write_glyphs(font)
+
+    # the first of equal code points wins, as with write()
+    seen = {}
+    for code, width, pixels in glyphs:
+        seen.setdefault(code, (width, pixels))
+
+    bpp = font["BPP"]
+    flags = 0
+    index = bytearray()
+    bitmaps = bytearray()
+    for code in sorted(seen):
+        width, pixels = seen[code]
+        data = pack_bits(pixels, bpp)
+        glyph_flags = 0
+        if rle:
+            runs = encode_runs(pixels, bpp)
+            if len(runs) < len(data):
+                data = runs
+                glyph_flags = FLAG_RLE
+        if len(data) > 0xFFFF:
+            raise ValueError("glyph {:#x} is too large".format(code))
+        index += struct.pack(ENTRY, code, len(bitmaps), width, glyph_flags, len(data))
+        bitmaps += data
+        flags |= glyph_flags
+
+    offset = struct.calcsize(HEADER) + len(index)
+    header = struct.pack(
+        HEADER, MAGIC, bpp, font["HEIGHT"], font["MAX_WIDTH"],
+        flags, len(seen), 0, offset)
+    return header + index + bitmaps
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert a font module to the binary font format of rm67162.Font.")
+    parser.add_argument("font", help="font module, e.g. fonts/bitmap/vga1_16x32.py")
+    parser.add_argument("output", nargs="?", help="binary font, default font with .rmf")
+    parser.add_argument("--rle", action="store_true", help="run-length encode the glyphs")
+    args = parser.parse_args()
+
+    output = args.output or os.path.splitext(args.font)[0] + ".rmf"
+    data = convert(load_font(args.font), args.rle)
+    with open(output, "wb") as f:
+        f.write(data)
+    print("{}: {} bytes".format(output, len(data)))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
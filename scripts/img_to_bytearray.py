@@ -10,10 +10,10 @@ except ImportError:
     print(" or follow the installation instructions for your platform at https://pillow.readthedocs.io")
     sys.exit(1)
 
-def convert_image_to_bitmap(image_path, output_file=None, converted_image_path=None, target_width=536, target_height=240):
+def convert_image_to_bitmap(image_path, output_file=None, converted_image_path=None, target_width=536, target_height=240, raw=False):
     # Set default output file if not provided
     if output_file is None:
-        output_file = os.path.splitext(image_path)[0] + ".py"
+        output_file = os.path.splitext(image_path)[0] + (".raw" if raw else ".py")
 
     with Image.open(image_path) as img:
         # Resize the image to fit within the target dimensions while maintaining aspect ratio
@@ -36,6 +36,13 @@ def convert_image_to_bitmap(image_path, output_file=None, converted_image_path=N
                 bitmap_data[index] = (color565 >> 8) & 0xFF
                 bitmap_data[index + 1] = color565 & 0xFF
 
+    # Raw pixel data for bitmap_file(), which needs the size given
+    if raw:
+        with open(output_file, "wb") as f:
+            f.write(bitmap_data)
+        print(f"Raw bitmap of {width}x{height} saved as: {output_file}")
+        return
+
     # Write the bitmap data to the output file in Python bytearray format
     with open(output_file, "w") as f:
         f.write("__bitmap = \\\n")
@@ -58,6 +65,7 @@ if __name__ == "__main__":
     parser.add_argument("output_file", nargs="?", help="Path to the output .py file. Defaults to the same path as input image with .py extension.")
     parser.add_argument("-w", "--width", type=int, default=536, help="Target width for the image. Default is 536.")
     parser.add_argument("-ht", "--height", type=int, default=240, help="Target height for the image. Default is 240.")
+    parser.add_argument("-r", "--raw", action="store_true", help="Write the raw color565 pixel data for bitmap_file() instead of a .py file.")
     parser.add_argument("-d", "-debug", "--converted_image_path", nargs="?", const="", help="Path to save the resized image for debugging purposes. If no path is provided, the converted image will be saved as <input>_conv.png.")
 
     args = parser.parse_args()
@@ -72,4 +80,4 @@ if __name__ == "__main__":
     elif args.converted_image_path is None:
         args.converted_image_path = None
 
-    convert_image_to_bitmap(args.image_path, args.output_file, converted_image_path=args.converted_image_path, target_width=args.width, target_height=args.height)
\ No newline at end of file
+    convert_image_to_bitmap(args.image_path, args.output_file, converted_image_path=args.converted_image_path, target_width=args.width, target_height=args.height, raw=args.raw)
\ No newline at end of file